@@ -54,9 +54,11 @@ enum {
 	FindNext = 0x07, // BEL ^G
 	ToLine = 0x0C, //FF ^L
 	Replace = 0x12, //DC2 ^R
+	ReplaceAll = 0x15, //NAK ^U
 
 	// Console
 	Kill = 0x0B, //VT ^K
+	Edit = 0x14, //DC4 ^T
 
 	// Application global commands
 	Directory = 0x04, //EOT ^D
@@ -67,8 +69,6 @@ enum {
 	// Unused ASCII control codes
 	STX = 0x02, // " B b
 	DLE = 0x10, // 0 P p
-	DC4 = 0x14, // 4 T t
-	NAK = 0x15, // 5 U u
 	FS = 0x1C, // < \ |
 	GS = 0x1D, // = ] }
 	RS = 0x1E, // > ^ ~
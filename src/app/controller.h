@@ -20,6 +20,7 @@
 
 #include <string>
 #include <vector>
+#include "editor/text.h"
 #include "search/engine.h"
 
 // Abstract interface for centralized application actions.
@@ -28,13 +29,16 @@ public:
 	virtual ~Controller() = default;
 	virtual void change_dir(std::string path) = 0;
 	virtual void edit_file(std::string path) = 0;
+	// Open an editor which reads from this file descriptor, taking ownership
+	// of it, after whatever text was already read from it.
+	virtual void edit_stream(std::string title, int fd, std::string text) = 0;
 	virtual void rename_file(std::string from, std::string to) = 0;
 	virtual void close_file(std::string path) = 0;
 	virtual void find_in_file(std::string path, size_t index) = 0;
 	virtual void begin_search() = 0;
 	virtual void search_for(Search::spec) = 0;
-	virtual void set_clipboard(std::string text) = 0;
-	virtual std::string get_clipboard() = 0;
+	virtual void set_clipboard(Editor::Text text) = 0;
+	virtual Editor::Text get_clipboard() = 0;
 	virtual void cache_read(std::string name, std::vector<std::string> &lines) = 0;
 	virtual void cache_write(std::string name, const std::vector<std::string> &lines) = 0;
 };
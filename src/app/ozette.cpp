@@ -19,6 +19,7 @@
 #include <atomic>
 #include <fstream>
 #include <cstdlib>
+#include <cstring>
 #include <sys/stat.h>
 #include <unistd.h>
 #include "app/control.h"
@@ -26,6 +27,7 @@
 #include "app/path.h"
 #include "console/console.h"
 #include "dialog/confirmation.h"
+#include "editor/writer.h"
 #include "help/view.h"
 #include "search/dialog.h"
 #include "search/search.h"
@@ -47,6 +49,17 @@ Ozette::Ozette():
 	} else {
 		_cache_dir = _home_dir + "/.cache/ozette";
 	}
+	// Undo history beyond the budget goes out to the cache directory. The
+	// budget for each document is in megabytes.
+	Editor::Journal::set_spill_dir(_cache_dir);
+	if (const char *budget = std::getenv("OZETTE_UNDO_BUDGET")) {
+		size_t megabytes = std::strtoul(budget, nullptr, 10);
+		if (megabytes) Editor::Journal::set_budget(megabytes << 20);
+	}
+	// Saving waits for the disk, unless the user would rather not.
+	if (const char *sync = std::getenv("OZETTE_SYNC")) {
+		Editor::set_sync(0 != std::strcmp(sync, "0"));
+	}
 }
 
 void Ozette::change_dir(std::string path) {
@@ -72,18 +85,35 @@ void Ozette::edit_file(std::string path) {
 	}
 }
 
+void Ozette::edit_stream(std::string title, int fd, std::string text) {
+	// Every stream gets an editor of its own, even if its title is taken.
+	std::string name = title;
+	for (unsigned i = 2; _editors.count(name); ++i) {
+		name = title + " <" + std::to_string(i) + ">";
+	}
+	std::unique_ptr<Editor::Stream> source(new Editor::Stream(fd, text));
+	editor edrec;
+	edrec.view = new Editor::View(name, std::move(source));
+	edrec.stream = true;
+	std::unique_ptr<UI::View> edptr(edrec.view);
+	edrec.window = _shell.open_window(std::move(edptr));
+	_editors[name] = edrec;
+}
+
 void Ozette::rename_file(std::string from, std::string to) {
 	// Somebody has moved or renamed a file. If there is an editor
 	// open for it, update our editor map.
-	auto existing = _editors.find(Path::absolute(from));
+	auto existing = find_editor(from);
 	if (existing == _editors.end()) return;
 	auto edrec = existing->second;
 	_editors.erase(existing);
+	// Once a stream has been saved, it is a file like any other.
+	edrec.stream = false;
 	_editors[Path::absolute(to)] = edrec;
 }
 
 void Ozette::close_file(std::string path) {
-	auto iter = _editors.find(Path::absolute(path));
+	auto iter = find_editor(path);
 	if (iter != _editors.end()) {
 		_shell.close_window(iter->second.window);
 		_editors.erase(iter);
@@ -101,11 +131,11 @@ void Ozette::find_in_file(std::string path, Editor::line_t index) {
 	}
 }
 
-void Ozette::set_clipboard(std::string text) {
+void Ozette::set_clipboard(Editor::Text text) {
 	_clipboard = text;
 }
 
-std::string Ozette::get_clipboard() {
+Editor::Text Ozette::get_clipboard() {
 	return _clipboard;
 }
 
@@ -158,6 +188,12 @@ Ozette::editor Ozette::open_editor(std::string path) {
 	return edrec;
 }
 
+std::map<std::string, Ozette::editor>::iterator Ozette::find_editor(
+		std::string name) {
+	auto iter = _editors.find(name);
+	return iter != _editors.end()? iter: _editors.find(Path::absolute(name));
+}
+
 void Ozette::begin_search() {
 	Search::View::show(_shell);
 	// Restore the previous search settings, if we cached them.
@@ -197,7 +233,7 @@ void Ozette::save_session() {
 		std::vector<std::string> files;
 		files.reserve(_editors.size());
 		for (auto wpair: _editors) {
-			files.push_back(wpair.first);
+			if (!wpair.second.stream) files.push_back(wpair.first);
 		}
 		cache_write(CacheKey::kSessionState, files);
 	}
@@ -246,10 +282,14 @@ void Ozette::quit() {
 		dialog.supplement.push_back(Path::display(wpair.first));
 	}
 	dialog.yes = [this, modified](UI::Frame &ctx) {
-		// Tell all of the modified files to save.
+		// Tell all of the modified files to save, then wait for the saves,
+		// which run in parallel, to finish.
 		for (auto wpair: modified) {
 			wpair.second.view->process(ctx, Control::Save);
 		}
+		for (auto wpair: modified) {
+			wpair.second.view->finish_save(ctx);
+		}
 		// If any of those files remain modified, the editor must have opened
 		// a dialog box asking for further input. Cancel the quit while the
 		// user works it out. Otherwise, close all windows now.
@@ -276,11 +316,14 @@ void Ozette::run() {
 		show_browser();
 		load_session();
 	}
-	timeout(100);
 	do {
 		if (sig_io_flag.exchange(false)) {
 			_shell.poll();
 		}
+		// If something asked to be polled again while we were polling, such
+		// as a stream with more text waiting, check for a keystroke, but
+		// don't wait around for one.
+		timeout(sig_io_flag.load()? 0: 100);
 		int ch = fix_control_quirks(getch());
 		switch (ch) {
 			case Control::UpArrow: show_browser(); break;
@@ -326,7 +369,7 @@ void Ozette::new_file() {
 	std::string path = _current_dir;
 	for (auto wpair: _editors) {
 		if (wpair.second.window == _shell.active()) {
-			if (!wpair.first.empty()) {
+			if (!wpair.second.stream && !wpair.first.empty()) {
 				path = Path::absolute(wpair.first);
 				size_t trunc = path.find_last_of('/');
 				if (trunc == std::string::npos) {
@@ -387,10 +430,18 @@ void Ozette::execute() {
 }
 
 void Ozette::build() {
-	// Save all open editors. Execute the build command for this directory.
+	// Save all open editors. The saves run in parallel, but they must all be
+	// finished before we execute the build command for this directory. The
+	// output of some command is not part of the build, and saving it would
+	// only ask where to put it.
 	for (auto &edit_pair: _editors) {
+		if (edit_pair.second.stream) continue;
 		edit_pair.second.window->process(Control::Save);
 	}
+	for (auto &edit_pair: _editors) {
+		if (edit_pair.second.stream) continue;
+		edit_pair.second.view->finish_save(*edit_pair.second.window);
+	}
 	exec("make");
 }
 
@@ -31,11 +31,12 @@ public:
 	Ozette();
 	virtual void change_dir(std::string path) override;
 	virtual void edit_file(std::string path) override;
+	virtual void edit_stream(std::string title, int fd, std::string text) override;
 	virtual void rename_file(std::string from, std::string to) override;
 	virtual void close_file(std::string path) override;
 	virtual void find_in_file(std::string path, Editor::line_t index) override;
-	virtual void set_clipboard(std::string text) override;
-	virtual std::string get_clipboard() override;
+	virtual void set_clipboard(Editor::Text text) override;
+	virtual Editor::Text get_clipboard() override;
 	virtual void cache_read(std::string name, std::vector<std::string> &lines) override;
 	virtual void cache_write(std::string name, const std::vector<std::string> &lines) override;
 	virtual void begin_search() override;
@@ -46,6 +47,9 @@ private:
 	struct editor {
 		UI::Window *window;
 		Editor::View *view;
+		// Is this the output of some command, which has not yet been saved
+		// anywhere? Such an editor goes by its title instead of a path.
+		bool stream = false;
 	};
 	void show_browser();
 	void change_directory();
@@ -57,6 +61,7 @@ private:
 	int fix_control_quirks(int ch);
 	void exec(std::string command);
 	editor open_editor(std::string path);
+	std::map<std::string, editor>::iterator find_editor(std::string name);
 	void save_session();
 	void load_session();
 	void quit();
@@ -65,7 +70,7 @@ private:
 	std::string _current_dir;
     std::string _cache_dir;
 	std::map<std::string, editor> _editors;
-	std::string _clipboard;
+	Editor::Text _clipboard;
 	bool _done = false;
 	bool _browser_mode = false;
 };
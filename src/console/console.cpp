@@ -18,6 +18,7 @@
 #include "console/console.h"
 #include "app/control.h"
 #include <assert.h>
+#include <unistd.h>
 
 Console::View *Console::View::_instance;
 
@@ -47,6 +48,7 @@ bool Console::View::process(UI::Frame &ctx, int ch) {
 	switch (ch) {
 		case Control::Close: return false;
 		case Control::Kill: ctl_kill(ctx); break;
+		case Control::Edit: ctl_edit(ctx); break;
 		case KEY_UP: key_up(ctx); break;
 		case KEY_DOWN: key_down(ctx); break;
 		case KEY_NPAGE: key_page_down(ctx); break;
@@ -60,7 +62,7 @@ bool Console::View::poll(UI::Frame &ctx) {
 	// We only need to poll if we have an active subprocess.
 	if (!_proc.get()) return true;
 	bool follow_edge = _scrollpos == maxscroll();
-	bool dirty = _log->read(_proc->out_fd());
+	bool dirty = !_handed_off && _log->read(_proc->out_fd());
 	dirty |= _log->read(_proc->err_fd());
 	if (follow_edge && _scrollpos != maxscroll()) {
 		_scrollpos = maxscroll();
@@ -78,6 +80,7 @@ bool Console::View::poll(UI::Frame &ctx) {
 
 void Console::View::set_help(UI::HelpBar::Panel &panel) {
 	if (_proc.get()) panel.kill();
+	if (_log.get() && !_handed_off) panel.edit();
 }
 
 Console::View::View() {
@@ -122,6 +125,7 @@ void Console::View::exec(
 	delete[] argv;
 	_scrollpos = 0;
 	_log.reset(new Log(title, _width));
+	_handed_off = false;
 }
 
 void Console::View::ctl_kill(UI::Frame &ctx) {
@@ -131,6 +135,20 @@ void Console::View::ctl_kill(UI::Frame &ctx) {
 	}
 }
 
+void Console::View::ctl_edit(UI::Frame &ctx) {
+	// Open the command's output in an editor, beginning with everything it
+	// has logged so far. If the command is still running, the editor will
+	// go on reading what it writes from here on; only its errors will still
+	// come to the console.
+	if (!_log.get() || _handed_off) return;
+	int fd = -1;
+	if (_proc.get()) {
+		fd = dup(_proc->out_fd());
+		_handed_off = true;
+	}
+	ctx.app().edit_stream("$ " + _log->command(), fd, _log->raw());
+}
+
 void Console::View::key_down(UI::Frame &ctx) {
 	if (_scrollpos < maxscroll()) {
 		_scrollpos++;
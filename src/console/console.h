@@ -50,6 +50,7 @@ private:
 			const std::string &exe,
 			const std::vector<std::string> &argv);
 	void ctl_kill(UI::Frame &ctx);
+	void ctl_edit(UI::Frame &ctx);
 	void key_up(UI::Frame &ctx);
 	void key_down(UI::Frame &ctx);
 	void key_page_up(UI::Frame &ctx);
@@ -58,6 +59,8 @@ private:
 	unsigned maxscroll() const;
 	std::unique_ptr<Subproc> _proc;
 	std::unique_ptr<Log> _log;
+	// has an editor taken over the command's output?
+	bool _handed_off = false;
 	unsigned _scrollpos = 0;
 	int _height = 0;
 	int _width = 0;
@@ -32,6 +32,8 @@ public:
 	size_t size() const { return _lines.size(); }
 	const std::string &operator[](size_t index) const { return _lines[index]; }
 	const std::string &command() const { return _command; }
+	// Everything the command has written so far, exactly as it came in.
+	const std::string &raw() const { return _raw; }
 private:
 	void read_one(char ch);
 	std::string _command;
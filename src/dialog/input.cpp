@@ -115,7 +115,7 @@ void Dialog::Input::ctl_copy(UI::Frame &ctx) {
 
 void Dialog::Input::ctl_paste(UI::Frame &ctx) {
 	delete_selection(ctx);
-	std::string clip = ctx.app().get_clipboard();
+	std::string clip = ctx.app().get_clipboard().str();
 	_value = _value.substr(0, _cursor_pos) + clip + _value.substr(_cursor_pos);
 	_cursor_pos += clip.size();
 	_anchor_pos = _cursor_pos;
@@ -0,0 +1,68 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/arena.h"
+#include <cstring>
+#include <sys/mman.h>
+
+namespace {
+// Chunks are big enough to amortize the cost of mapping them, but small
+// enough that a few stragglers cannot pin very much memory. A line too long
+// to share a chunk gets one of its own, sized to fit.
+const size_t kChunkSize = 256 * 1024;
+} // namespace
+
+struct Editor::Arena::Chunk {
+	Chunk(size_t size);
+	~Chunk();
+	char *bytes = nullptr;
+	size_t capacity = 0;
+	size_t used = 0;
+};
+
+Editor::Arena::Chunk::Chunk(size_t size) {
+	// We map chunks directly, rather than going through malloc, so that the
+	// memory really does go back to the system when the chunk is released.
+	void *addr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (addr == MAP_FAILED) throw std::bad_alloc();
+	bytes = static_cast<char*>(addr);
+	capacity = size;
+}
+
+Editor::Arena::Chunk::~Chunk() {
+	munmap(bytes, capacity);
+}
+
+const char *Editor::Arena::store(const char *data, size_t size,
+		std::shared_ptr<const void> &owner) {
+	std::shared_ptr<Chunk> chunk = _chunk;
+	if (size > kChunkSize / 4) {
+		chunk = std::make_shared<Chunk>(size);
+	} else if (!chunk || chunk->capacity - chunk->used < size) {
+		chunk = _chunk = std::make_shared<Chunk>(kChunkSize);
+	}
+	char *dest = chunk->bytes + chunk->used;
+	memcpy(dest, data, size);
+	chunk->used += size;
+	owner = chunk;
+	return dest;
+}
+
+size_t Editor::Arena::capacity(const std::shared_ptr<const void> &owner) {
+	return static_cast<const Chunk*>(owner.get())->capacity;
+}
@@ -0,0 +1,44 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#ifndef EDITOR_ARENA_H
+#define EDITOR_ARENA_H
+
+#include <memory>
+
+// An arena packs the text of many lines end to end in large chunks, so that
+// a big paste or a file read from a stream costs one allocation per chunk
+// rather than one per line. Line text never changes once stored, so nothing
+// is ever freed from the middle of a chunk; each line holds a reference to
+// its chunk, and the chunk goes back to the operating system once every line
+// stored in it is gone.
+namespace Editor {
+class Arena {
+public:
+	// Copy these bytes into the arena, setting the owner to a reference which
+	// will keep them alive, and return their new address.
+	const char *store(const char *data, size_t size,
+			std::shared_ptr<const void> &owner);
+	// How much memory does the chunk behind this owner reference occupy?
+	static size_t capacity(const std::shared_ptr<const void> &owner);
+private:
+	struct Chunk;
+	std::shared_ptr<Chunk> _chunk;
+};
+} // namespace Editor
+
+#endif // EDITOR_ARENA_H
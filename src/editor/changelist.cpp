@@ -20,117 +20,151 @@
 #include <assert.h>
 
 void Editor::ChangeList::clear() {
-	while (!_done.empty()) _done.pop();
-	while (!_undone.empty()) _undone.pop();
+	_done.clear();
+	_undone.clear();
 	_committed = false;
 }
 
-void Editor::ChangeList::erase(const Range &loc, std::string text) {
-	while(!_undone.empty()) _undone.pop();
+bool Editor::ChangeList::restore(std::string path, uint64_t contents,
+		std::function<uint64_t()> lines) {
+	if (!_done.restore(path, contents, lines)) return false;
+	// The last change from the previous session is finished, and the next
+	// edit must not try to combine with it.
+	_committed = true;
+	return true;
+}
+
+void Editor::ChangeList::preserve(
+		std::string path, uint64_t contents, uint64_t lines) {
+	_done.preserve(path, contents, lines);
+}
+
+void Editor::ChangeList::erase(const Range &loc, const Text &text) {
+	if (!_replaying) _undone.clear();
 	assert(!loc.empty());
 	if (combine_erase(loc, text)) return;
-	change_t temp;
+	Change temp;
 	temp.erase = true;
 	temp.eraseloc = loc;
-	temp.erasetext = text;
-	_done.push(temp);
-	_committed = false;
+	record(temp);
+	_done.append(text, false);
 }
 
 void Editor::ChangeList::insert(const Range &loc) {
-	while(!_undone.empty()) _undone.pop();
+	if (!_replaying) _undone.clear();
 	assert(!loc.empty());
 	if (combine_insert(loc)) return;
-	change_t temp;
+	Change temp;
 	temp.insert = true;
 	temp.insertloc = loc;
-	_done.push(temp);
-	_committed = false;
+	record(temp);
 }
 
 void Editor::ChangeList::split(location_t loc) {
-	while(!_undone.empty()) _undone.pop();
+	if (!_replaying) _undone.clear();
 	if (combine_split(loc)) return;
-	change_t temp;
+	Change temp;
 	temp.split = true;
 	temp.splitloc = loc;
-	_done.push(temp);
-	_committed = false;
+	record(temp);
 }
 
 Editor::location_t Editor::ChangeList::undo(Document &doc, Update &update) {
 	if (_done.empty()) return location_t();
-	std::stack<change_t> undone = std::move(_undone);
-	// Remove the last change from the done list, then reverse its effect.
-	change_t temp = _done.top();
-	_done.pop();
-	location_t out = temp.rollback(doc, update);
-	// Reversing the effect of the last change is a new change, which will go
-	// onto the undo stack. That's great but this is really the inverse of a
-	// change, so we will pop it off the "done" stack and put it onto the
-	// "undone" stack, so that the next undo will apply to the previous "done"
-	// action. We can undo the undo by invoking "redo". This is how we get to
+	// Remove the last edit from the done list, then reverse its effect, one
+	// change at a time, beginning with the last.
+	std::vector<Change> edit;
+	do {
+		edit.push_back(_done.pop());
+	} while (edit.back().joined && !_done.empty());
+	location_t out = replay(edit, doc, update);
+	// Reversing the effect of the last edit makes new changes, which go
+	// onto the done list. That's great but they are really the inverse of
+	// the edit, so we will move them off the "done" list and onto the
+	// "undone" list, so that the next undo will apply to the previous "done"
+	// edit. We can undo the undo by invoking "redo". This is how we get to
 	// have multilevel undo.
-	_undone = std::move(undone);
-	_undone.push(_done.top());
-	_done.pop();
+	std::vector<Change> inverse;
+	while (_done.count() > _base) {
+		inverse.push_back(_done.pop());
+	}
+	for (auto iter = inverse.rbegin(); iter != inverse.rend(); ++iter) {
+		_undone.push(*iter);
+	}
 	_committed = true;
 	return out;
 }
 
 Editor::location_t Editor::ChangeList::redo(Document &doc, Update &update) {
 	if (_undone.empty()) return location_t();
-	// Remove the most recent change from the undone list, then reverse its
-	// effect. This will re-implement whatever the original change was, which
-	// will push a new action onto the _done list, effectively transferring the
-	// change from the "undone" list to the "done" list.
-	change_t temp = _undone.top();
-	_undone.pop();
-	std::stack<change_t> undone = std::move(_undone);
-	location_t out = temp.rollback(doc, update);
-	_undone = std::move(undone);
+	// Remove the most recent edit from the undone list, then reverse its
+	// effect. This will re-implement whatever the original edit was, which
+	// will push new changes onto the _done list, effectively transferring the
+	// edit from the "undone" list to the "done" list.
+	std::vector<Change> edit;
+	do {
+		edit.push_back(_undone.pop());
+	} while (edit.back().joined && !_undone.empty());
+	location_t out = replay(edit, doc, update);
 	_committed = true;
 	return out;
 }
 
 void Editor::ChangeList::commit() {
-	while (!_undone.empty()) _undone.pop();
+	_undone.clear();
 	if (_done.empty()) return;
 	_committed = true;
 }
 
-bool Editor::ChangeList::combine_erase(const Range &loc, std::string text) {
+void Editor::ChangeList::begin_edit() {
+	commit();
+	_replaying = true;
+	_base = _done.count();
+	_committed = true;
+}
+
+void Editor::ChangeList::end_edit() {
+	_replaying = false;
+	_committed = true;
+}
+
+bool Editor::ChangeList::combine_erase(const Range &loc, const Text &text) {
 	if (_done.empty()) return false;
-	auto &top = _done.top();
 	if (_committed) return false;
+	Change top = _done.peek();
 	if (top.split) return false;
 	if (top.insert) return false;
 	if (top.erase) {
 		// This change already includes an erase. Can we combine this erase
 		// with the previous one? This works if the new range immediately
-		// precedes or succeeds the existing range.
+		// precedes or succeeds the existing range. Either way, the text
+		// goes on the end of the record, so holding down delete or
+		// backspace costs the same for every character.
 		if (loc.begin() == top.eraseloc.end()) {
-			top.erasetext = top.erasetext + text;
 			top.eraseloc.extend(loc.end());
+			_done.amend(top);
+			_done.append(text, false);
 			return true;
 		}
 		if (loc.end() == top.eraseloc.begin()) {
-			top.erasetext = text + top.erasetext;
 			top.eraseloc.extend(loc.begin());
+			_done.amend(top);
+			_done.append(text, true);
 			return true;
 		}
 		return false;
 	}
 	top.erase = true;
 	top.eraseloc = loc;
-	top.erasetext = text;
+	_done.amend(top);
+	_done.append(text, false);
 	return true;
 }
 
 bool Editor::ChangeList::combine_insert(const Range &loc) {
 	if (_done.empty()) return false;
-	auto &top = _done.top();
 	if (_committed) return false;
+	Change top = _done.peek();
 	if (top.split) return false;
 	if (top.insert) {
 		// The topmost change already includes an insert. If this insert
@@ -138,12 +172,14 @@ bool Editor::ChangeList::combine_insert(const Range &loc) {
 		// they must be recorded as separate edits.
 		if (loc.begin() == top.insertloc.end()) {
 			top.insertloc.extend(loc.end());
+			_done.amend(top);
 			return true;
 		}
 		return false;
 	}
 	top.insert = true;
 	top.insertloc = loc;
+	_done.amend(top);
 	return true;
 }
 
@@ -151,27 +187,51 @@ bool Editor::ChangeList::combine_split(location_t loc) {
 	// Try to combine this split with the topmost change. If we cannot combine,
 	// return false so the caller knows it's time for a new change record.
 	if (_done.empty()) return false;
-	auto &top = _done.top();
 	if (_committed) return false;
+	Change top = _done.peek();
 	if (top.split) return false;
 	top.split = true;
 	top.splitloc = loc;
+	_done.amend(top);
 	return true;
 }
 
-Editor::location_t Editor::ChangeList::change_t::rollback(
-		Document &doc, Update &update) {
+void Editor::ChangeList::record(Change &change) {
+	// While replaying an edit, every change after the first belongs with it.
+	change.joined = _replaying && _done.count() > _base;
+	_done.push(change);
+	_committed = false;
+}
+
+Editor::location_t Editor::ChangeList::replay(
+		const std::vector<Change> &edit, Document &doc, Update &update) {
+	_replaying = true;
+	_base = _done.count();
+	_committed = true;
+	location_t out;
+	for (auto &change: edit) {
+		out = rollback(change, doc, update);
+	}
+	_replaying = false;
+	return out;
+}
+
+Editor::location_t Editor::ChangeList::rollback(
+		const Change &change, Document &doc, Update &update) {
 	location_t out;
-	if (split) {
-		// We inserted a linebreak at the splitloc. Delete it.
+	if (change.split) {
+		// We inserted a linebreak at the splitloc. Delete it. Every line
+		// after it moves up by one, so they all need repainting.
+		location_t splitloc = change.splitloc;
 		Range span(splitloc, doc.next_char(splitloc));
 		doc.erase(span);
-		update.range(span);
+		update.forward(splitloc);
 		out = splitloc;
 	}
-	if (insert) {
+	if (change.insert) {
 		// We inserted some text, which now occupies the range specified by
 		// insertloc. Delete that text.
+		const Range &insertloc = change.insertloc;
 		doc.erase(insertloc);
 		out = insertloc.begin();
 		if (insertloc.multiline()) {
@@ -180,11 +240,12 @@ Editor::location_t Editor::ChangeList::change_t::rollback(
 			update.range(insertloc);
 		}
 	}
-	if (erase) {
+	if (change.erase) {
 		// We erased some text, which was at the range specified by eraseloc,
 		// and which we have saved as erasetext. Re-insert it at the beginning
 		// of the eraseloc.
-		doc.insert(eraseloc.begin(), erasetext);
+		const Range &eraseloc = change.eraseloc;
+		doc.insert(eraseloc.begin(), Text(change.erasetext));
 		if (eraseloc.multiline()) {
 			update.forward(eraseloc.begin());
 		} else {
@@ -18,9 +18,12 @@
 #ifndef EDITOR_CHANGELIST_H
 #define EDITOR_CHANGELIST_H
 
+#include <functional>
 #include <string>
-#include <stack>
+#include <vector>
 #include "editor/coordinates.h"
+#include "editor/journal.h"
+#include "editor/text.h"
 #include "editor/update.h"
 
 namespace Editor {
@@ -30,7 +33,7 @@ public:
 	// Forget about all of the changes
 	void clear();
 	// Record a change that has been made
-	void erase(const Range &loc, std::string text);
+	void erase(const Range &loc, const Text &text);
 	void insert(const Range &loc);
 	void split(location_t loc);
 	// Roll back the last change, or re-apply the most recently undone change.
@@ -40,26 +43,35 @@ public:
 	// If we have undone some actions, forget them, because we are committing
 	// to the current state and beginning a new edit.
 	void commit();
+	// The changes recorded between these calls make up one edit, which will
+	// be undone or redone all at once.
+	void begin_edit();
+	void end_edit();
 	// Can we currently undo or redo an action?
 	bool can_undo() const { return !_done.empty(); }
 	bool can_redo() const { return !_undone.empty(); }
+	// Pick up the history saved along with a file, or save the history along
+	// with the file we just wrote; see Journal.
+	bool restore(std::string path, uint64_t contents,
+			std::function<uint64_t()> lines);
+	void preserve(std::string path, uint64_t contents, uint64_t lines);
 private:
-	bool combine_erase(const Range &loc, std::string text);
+	bool combine_erase(const Range &loc, const Text &text);
 	bool combine_insert(const Range &loc);
 	bool combine_split(location_t loc);
-	struct change_t {
-		location_t rollback(Document &doc, Update &update);
-		bool erase = false;
-		Range eraseloc;
-		std::string erasetext;
-		bool insert = false;
-		Range insertloc;
-		bool split = false;
-		location_t splitloc;
-	};
-	std::stack<change_t> _done;
-	std::stack<change_t> _undone;
+	void record(Change &change);
+	location_t replay(const std::vector<Change> &edit, Document &doc,
+			Update &update);
+	static location_t rollback(const Change &change, Document &doc,
+			Update &update);
+	Journal _done;
+	Journal _undone;
 	bool _committed = false;
+	// While we undo or redo an edit, or make one edit out of many changes,
+	// the changes go onto the done list as one edit, beginning above this
+	// many changes.
+	bool _replaying = false;
+	size_t _base = 0;
 };
 } // namespace Editor
 
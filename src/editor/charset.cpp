@@ -0,0 +1,281 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/charset.h"
+#include "editor/utf8.h"
+#include <algorithm>
+#include <cstring>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+// Files without a byte order mark are judged by their first few kilobytes.
+const size_t kSniffSize = 4096;
+const unsigned kReplacement = 0xFFFD;
+
+char *put(unsigned cp, char *dest) {
+	if (cp < 0x80) {
+		*dest++ = cp;
+	} else if (cp < 0x800) {
+		*dest++ = 0xC0 | (cp >> 6);
+		*dest++ = 0x80 | (cp & 0x3F);
+	} else if (cp < 0x10000) {
+		*dest++ = 0xE0 | (cp >> 12);
+		*dest++ = 0x80 | ((cp >> 6) & 0x3F);
+		*dest++ = 0x80 | (cp & 0x3F);
+	} else {
+		*dest++ = 0xF0 | (cp >> 18);
+		*dest++ = 0x80 | ((cp >> 12) & 0x3F);
+		*dest++ = 0x80 | ((cp >> 6) & 0x3F);
+		*dest++ = 0x80 | (cp & 0x3F);
+	}
+	return dest;
+}
+
+unsigned unit(const unsigned char *src, size_t i, bool big) {
+	return big? (src[2*i] << 8 | src[2*i+1]): (src[2*i+1] << 8 | src[2*i]);
+}
+
+size_t decode_latin1(const char *data, size_t size, char *dest) {
+	char *out = dest;
+	size_t pos = 0;
+	while (pos < size) {
+		size_t stop = size;
+#if defined(__SSE2__)
+		// Copy ASCII straight across, sixteen bytes at a time, and fall back
+		// to the scalar loop for a chunk with anything else in it.
+		for (; pos + 16 <= size; pos += 16) {
+			__m128i chunk = _mm_loadu_si128((const __m128i*)(data + pos));
+			if (_mm_movemask_epi8(chunk)) break;
+			_mm_storeu_si128((__m128i*)out, chunk);
+			out += 16;
+		}
+		stop = std::min(size, pos + 16);
+#endif
+		for (; pos < stop; ++pos) {
+			out = put((unsigned char)data[pos], out);
+		}
+	}
+	return out - dest;
+}
+
+size_t decode_utf16(const char *data, size_t size, bool big, char *dest) {
+	auto src = (const unsigned char*)data;
+	size_t units = size / 2;
+	char *out = dest;
+	size_t i = 0;
+	while (i < units) {
+		size_t stop = units;
+#if defined(__SSE2__)
+		// Eight units at a time: if none of them is beyond ASCII, packing
+		// them down to bytes is all the transcoding they need.
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i high = _mm_set1_epi16((short)0xFF80);
+		for (; i + 8 <= units; i += 8) {
+			__m128i chunk = _mm_loadu_si128((const __m128i*)(src + 2*i));
+			if (big) {
+				chunk = _mm_or_si128(
+						_mm_slli_epi16(chunk, 8), _mm_srli_epi16(chunk, 8));
+			}
+			__m128i test = _mm_cmpeq_epi16(_mm_and_si128(chunk, high), zero);
+			if (_mm_movemask_epi8(test) != 0xFFFF) break;
+			_mm_storel_epi64((__m128i*)out, _mm_packus_epi16(chunk, chunk));
+			out += 8;
+		}
+		stop = std::min(units, i + 8);
+#endif
+		while (i < stop) {
+			unsigned cp = unit(src, i++, big);
+			if (cp >= 0xD800 && cp <= 0xDBFF && i < units) {
+				unsigned low = unit(src, i, big);
+				if (low >= 0xDC00 && low <= 0xDFFF) {
+					cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+					++i;
+				}
+			}
+			if (cp >= 0xD800 && cp <= 0xDFFF) cp = kReplacement;
+			out = put(cp, out);
+		}
+	}
+	// An odd byte at the end can't be a character by itself.
+	if (size & 1) out = put(kReplacement, out);
+	return out - dest;
+}
+
+bool encode_latin1(const char *data, size_t size, std::string &out) {
+	size_t pos = 0;
+	while (pos < size) {
+		size_t end = Editor::skip_ascii(data, pos, size);
+		out.append(data + pos, end - pos);
+		pos = end;
+		if (pos == size) break;
+		// Only U+0080 through U+00FF have a place in Latin-1.
+		auto p = (const unsigned char*)data + pos;
+		if (2 != Editor::sequence(p, size - pos) || p[0] > 0xC3) return false;
+		out.push_back((char)(((p[0] & 0x1F) << 6) | (p[1] & 0x3F)));
+		pos += 2;
+	}
+	return true;
+}
+
+void put_unit(unsigned u, bool big, std::string &out) {
+	char bytes[2] = {(char)(u & 0xFF), (char)(u >> 8)};
+	if (big) std::swap(bytes[0], bytes[1]);
+	out.append(bytes, 2);
+}
+
+void widen(const char *data, size_t size, bool big, std::string &out) {
+	// Each ASCII byte becomes a unit with a zero alongside it, which is
+	// just what unpacking against a zero vector produces.
+	size_t base = out.size();
+	out.resize(base + 2 * size);
+	char *dest = &out[base];
+	size_t pos = 0;
+#if defined(__SSE2__)
+	const __m128i zero = _mm_setzero_si128();
+	for (; pos + 16 <= size; pos += 16) {
+		__m128i chunk = _mm_loadu_si128((const __m128i*)(data + pos));
+		__m128i lo = big?
+				_mm_unpacklo_epi8(zero, chunk): _mm_unpacklo_epi8(chunk, zero);
+		__m128i hi = big?
+				_mm_unpackhi_epi8(zero, chunk): _mm_unpackhi_epi8(chunk, zero);
+		_mm_storeu_si128((__m128i*)(dest + 2*pos), lo);
+		_mm_storeu_si128((__m128i*)(dest + 2*pos + 16), hi);
+	}
+#endif
+	for (; pos < size; ++pos) {
+		dest[2*pos + (big? 0: 1)] = 0;
+		dest[2*pos + (big? 1: 0)] = data[pos];
+	}
+}
+
+bool encode_utf16(const char *data, size_t size, bool big, std::string &out) {
+	size_t pos = 0;
+	while (pos < size) {
+		size_t end = Editor::skip_ascii(data, pos, size);
+		widen(data + pos, end - pos, big, out);
+		pos = end;
+		if (pos == size) break;
+		auto p = (const unsigned char*)data + pos;
+		size_t len = Editor::sequence(p, size - pos);
+		if (0 == len) return false;
+		unsigned cp = p[0] & (0x7F >> len);
+		for (size_t i = 1; i < len; ++i) {
+			cp = (cp << 6) | (p[i] & 0x3F);
+		}
+		if (cp >= 0x10000) {
+			cp -= 0x10000;
+			put_unit(0xD800 + (cp >> 10), big, out);
+			put_unit(0xDC00 + (cp & 0x3FF), big, out);
+		} else {
+			put_unit(cp, big, out);
+		}
+		pos += len;
+	}
+	return true;
+}
+} // namespace
+
+Editor::Charset Editor::detect(
+		const char *data, size_t size, Charset fallback, size_t &bom) {
+	auto p = (const unsigned char*)data;
+	if (size >= 3 && p[0] == 0xEF && p[1] == 0xBB && p[2] == 0xBF) {
+		bom = 3;
+		return Charset::UTF8BOM;
+	}
+	if (size >= 2 && p[0] == 0xFE && p[1] == 0xFF) {
+		bom = 2;
+		return Charset::UTF16BE;
+	}
+	if (size >= 2 && p[0] == 0xFF && p[1] == 0xFE) {
+		bom = 2;
+		return Charset::UTF16LE;
+	}
+	bom = 0;
+	if (fallback != Charset::UTF8) return fallback;
+	// Text in a Latin script encoded as UTF-16 has a zero in half of its
+	// bytes, always on the same side of each unit; UTF-8 text has none.
+	size_t pairs = std::min(size, kSniffSize) / 2;
+	size_t even = 0, odd = 0;
+	for (size_t i = 0; i < pairs; ++i) {
+		if (0 == p[2*i]) ++even;
+		if (0 == p[2*i+1]) ++odd;
+	}
+	if (0 == even && odd > pairs / 2) return Charset::UTF16LE;
+	if (0 == odd && even > pairs / 2) return Charset::UTF16BE;
+	// Text which isn't UTF-8 is most likely Latin-1, which can represent any
+	// byte at all. We don't look past the window, so we must not judge the
+	// character the window cuts in half. A binary file stays as it is, so
+	// it can go on being read straight out of its mapping.
+	size_t window = std::min(size, kSniffSize);
+	if (memchr(data, '\0', window)) return fallback;
+	if (window < size) {
+		for (size_t back = 0; back < 3 && 0x80 == (p[window] & 0xC0); ++back) {
+			--window;
+		}
+	}
+	if (TextClass::Invalid == classify(data, window)) return Charset::Latin1;
+	return fallback;
+}
+
+std::string Editor::byte_order_mark(Charset charset) {
+	switch (charset) {
+		case Charset::UTF8BOM: return "\xEF\xBB\xBF";
+		case Charset::UTF16BE: return "\xFE\xFF";
+		case Charset::UTF16LE: return "\xFF\xFE";
+		default: return "";
+	}
+}
+
+size_t Editor::decoded_bound(Charset charset, size_t size) {
+	switch (charset) {
+		case Charset::Latin1: return 2 * size;
+		case Charset::UTF16BE:
+		case Charset::UTF16LE: return 3 * (size / 2) + 3;
+		default: return size;
+	}
+}
+
+size_t Editor::decode(Charset charset, const char *data, size_t size, char *dest) {
+	switch (charset) {
+		case Charset::Latin1: return decode_latin1(data, size, dest);
+		case Charset::UTF16BE: return decode_utf16(data, size, true, dest);
+		case Charset::UTF16LE: return decode_utf16(data, size, false, dest);
+		default: memcpy(dest, data, size); return size;
+	}
+}
+
+bool Editor::encode(
+		Charset charset, const char *data, size_t size, std::string &out) {
+	switch (charset) {
+		case Charset::Latin1: return encode_latin1(data, size, out);
+		case Charset::UTF16BE: return encode_utf16(data, size, true, out);
+		case Charset::UTF16LE: return encode_utf16(data, size, false, out);
+		default: out.append(data, size); return true;
+	}
+}
+
+const char *Editor::name(Charset charset) {
+	switch (charset) {
+		case Charset::UTF8BOM: return "utf-8-bom";
+		case Charset::Latin1: return "latin1";
+		case Charset::UTF16BE: return "utf-16be";
+		case Charset::UTF16LE: return "utf-16le";
+		default: return "utf-8";
+	}
+}
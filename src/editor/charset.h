@@ -0,0 +1,57 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#ifndef EDITOR_CHARSET_H
+#define EDITOR_CHARSET_H
+
+#include <cstddef>
+#include <string>
+
+// The document always holds its text as UTF-8, but the files it comes from
+// and goes back to may use some other encoding. We transcode the whole file
+// when it is loaded, and each line as it is written out again; plain UTF-8
+// files skip both steps, so they cost no more than they did before.
+namespace Editor {
+enum class Charset {
+	UTF8,
+	UTF8BOM,
+	Latin1,
+	UTF16BE,
+	UTF16LE
+};
+// Work out how the file beginning with these bytes is encoded. A byte order
+// mark settles the question, UTF-16 without one gives itself away with all
+// its NULs, and text which is not valid UTF-8 must be Latin-1; otherwise, we
+// take the editorconfig's word for it. The bom value receives the number of
+// leading bytes to skip.
+Charset detect(const char *data, size_t size, Charset fallback, size_t &bom);
+// The byte order mark which should begin a file written in this charset.
+std::string byte_order_mark(Charset charset);
+// Transcoding into UTF-8 may expand the text, but never beyond this size.
+size_t decoded_bound(Charset charset, size_t size);
+// Transcode text from the charset into UTF-8, writing it into the buffer,
+// which must have room for decoded_bound() bytes, and returning the number
+// of bytes written. Malformed input becomes replacement characters.
+size_t decode(Charset charset, const char *data, size_t size, char *dest);
+// Transcode UTF-8 text into the charset, appending it to the output. Returns
+// false if the text includes some character the charset cannot represent.
+bool encode(Charset charset, const char *data, size_t size, std::string &out);
+// The charset's editorconfig name, for messages.
+const char *name(Charset charset);
+} // namespace Editor
+
+#endif // EDITOR_CHARSET_H
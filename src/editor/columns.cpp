@@ -0,0 +1,96 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/columns.h"
+#include <algorithm>
+
+Editor::column_t Editor::Columns::column(Document &doc, location_t loc,
+		unsigned tab_width, const Update &update) {
+	const Line &text = doc.line(loc.line);
+	auto iter = _entries.begin();
+	while (iter != _entries.end() && iter->line != loc.line) {
+		++iter;
+	}
+	if (iter == _entries.end()) {
+		if (_entries.size() >= kCapacity) {
+			_entries.pop_back();
+		}
+		_entries.insert(_entries.begin(), entry());
+		iter = _entries.begin();
+		iter->line = loc.line;
+		iter->tab_width = tab_width;
+		build(doc, *iter);
+	} else {
+		// Move this line to the front, so the least recently used line is
+		// the one we drop when we need room.
+		std::rotate(_entries.begin(), iter, iter + 1);
+		iter = _entries.begin();
+		if (!fresh(*iter, text, tab_width, update)) {
+			iter->tab_width = tab_width;
+			build(doc, *iter);
+		}
+	}
+	iter->text = text;
+	iter->generation = update.generation();
+	const std::vector<column_t> &columns = iter->columns;
+	return columns[std::min<size_t>(loc.offset, columns.size() - 1)];
+}
+
+bool Editor::Columns::fresh(const entry &e, const Line &text,
+		unsigned tab_width, const Update &update) const {
+	if (!e.text.same(text)) return false;
+	if (e.tab_width != tab_width) return false;
+	// If the update has marked this line since we built the entry, something
+	// about it has changed, so we had better look again.
+	return !(update.generation() != e.generation && update.is_dirty(e.line));
+}
+
+void Editor::Columns::build(Document &doc, entry &e) {
+	// Each offset gets the column of the character beginning there; an offset
+	// which lands inside a multibyte sequence gets the column following that
+	// character, just as if we had counted every character starting before it.
+	const Line &text = doc.line(e.line);
+	size_t size = text.size();
+	e.columns.assign(size + 1, 0);
+	column_t col = 0;
+	if (doc.ascii(e.line)) {
+		// Every byte is a character, so there is nothing to decode.
+		for (size_t i = 0; i < size; ++i) {
+			e.columns[i] = col++;
+			if (text[i] == '\t') {
+				col += (e.tab_width - col % e.tab_width);
+			}
+		}
+		e.columns[size] = col;
+		return;
+	}
+	location_t i = doc.home(e.line);
+	while (i.line == e.line && i.offset < size) {
+		location_t next = doc.next_char(i);
+		offset_t stop = (next.line == e.line)? next.offset: size;
+		e.columns[i.offset] = col;
+		++col;
+		if (doc.codepoint(i) == '\t') {
+			col += (e.tab_width - col % e.tab_width);
+		}
+		for (offset_t j = i.offset + 1; j < stop; ++j) {
+			e.columns[j] = col;
+		}
+		i = next;
+	}
+	e.columns[size] = col;
+}
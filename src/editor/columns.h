@@ -0,0 +1,55 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#ifndef EDITOR_COLUMNS_H
+#define EDITOR_COLUMNS_H
+
+#include <vector>
+#include "editor/coordinates.h"
+#include "editor/document.h"
+#include "editor/update.h"
+
+// Finding the screen column for a character means walking its line from the
+// beginning, expanding tabs and stepping over multibyte sequences. Cursor
+// motion and selection painting ask this question over and over for the same
+// few lines, so we remember the column of every offset on the lines we have
+// visited recently. A line's entry is rebuilt once the update has marked it
+// dirty, since that is how the view learns that its text may have changed.
+namespace Editor {
+class Columns {
+public:
+	column_t column(Document &doc, location_t loc, unsigned tab_width,
+			const Update &update);
+	void clear() { _entries.clear(); }
+private:
+	struct entry {
+		line_t line;
+		Line text;
+		unsigned tab_width;
+		unsigned long generation;
+		std::vector<column_t> columns;
+	};
+	bool fresh(const entry &e, const Line &text, unsigned tab_width,
+			const Update &update) const;
+	void build(Document &doc, entry &e);
+	// most recently used first; we seldom need more than a handful
+	std::vector<entry> _entries;
+	static const size_t kCapacity = 8;
+};
+} // namespace Editor
+
+#endif // EDITOR_COLUMNS_H
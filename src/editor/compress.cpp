@@ -0,0 +1,144 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/compress.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+// Matches are found by hashing every four bytes into a table of the most
+// recent position where each hash appeared; a match must be at least that
+// long, and can reach back no further than a 16-bit offset.
+const unsigned kHashBits = 16;
+const size_t kMinMatch = 4;
+const size_t kMaxOffset = 0xFFFF;
+
+uint32_t load32(const char *p) {
+	uint32_t out;
+	memcpy(&out, p, sizeof(out));
+	return out;
+}
+
+void put_length(std::string &out, size_t length) {
+	// Lengths too large for their half of the token byte continue in
+	// following bytes, each adding up to 255 more.
+	while (length >= 255) {
+		out.push_back(static_cast<char>(255));
+		length -= 255;
+	}
+	out.push_back(static_cast<char>(length));
+}
+
+bool get_length(const unsigned char *&in, const unsigned char *end, size_t &n) {
+	unsigned char more = 255;
+	while (more == 255) {
+		if (in == end) return false;
+		more = *in++;
+		n += more;
+	}
+	return true;
+}
+
+void put_sequence(std::string &out, const char *literals, size_t count,
+		size_t offset, size_t match) {
+	size_t token_at = out.size();
+	unsigned char token = (count < 15? count: 15) << 4;
+	out.push_back(0);
+	if (count >= 15) put_length(out, count - 15);
+	out.append(literals, count);
+	if (match) {
+		match -= kMinMatch;
+		token |= match < 15? match: 15;
+		out.push_back(static_cast<char>(offset & 0xFF));
+		out.push_back(static_cast<char>(offset >> 8));
+		if (match >= 15) put_length(out, match - 15);
+	}
+	out[token_at] = static_cast<char>(token);
+}
+} // namespace
+
+std::string Editor::compress(const char *data, size_t size) {
+	std::string out;
+	out.reserve(size / 2 + 16);
+	std::vector<uint32_t> table(1 << kHashBits, 0);
+	size_t pos = 0;
+	size_t anchor = 0;
+	while (pos + kMinMatch <= size) {
+		uint32_t seq = load32(data + pos);
+		uint32_t slot = (seq * 2654435761U) >> (32 - kHashBits);
+		// The table holds positions plus one, so zero can mean empty.
+		size_t candidate = table[slot];
+		table[slot] = static_cast<uint32_t>(pos + 1);
+		if (candidate && pos - (candidate - 1) <= kMaxOffset &&
+				load32(data + candidate - 1) == seq) {
+			size_t from = candidate - 1;
+			size_t length = kMinMatch;
+			while (pos + length < size && data[from + length] == data[pos + length]) {
+				length++;
+			}
+			put_sequence(out, data + anchor, pos - anchor, pos - from, length);
+			pos += length;
+			anchor = pos;
+		} else {
+			// The longer we go without a match, the faster we skip ahead, so
+			// text which won't compress doesn't take long to find that out.
+			pos += 1 + ((pos - anchor) >> 6);
+		}
+	}
+	put_sequence(out, data + anchor, size - anchor, 0, 0);
+	return out;
+}
+
+bool Editor::decompress(
+		const char *data, size_t size, size_t expected, std::string &out) {
+	out.clear();
+	out.reserve(expected);
+	auto in = reinterpret_cast<const unsigned char*>(data);
+	auto end = in + size;
+	while (in < end) {
+		unsigned char token = *in++;
+		size_t count = token >> 4;
+		if (count == 15 && !get_length(in, end, count)) return false;
+		if (count > (size_t)(end - in) || out.size() + count > expected) {
+			return false;
+		}
+		out.append(reinterpret_cast<const char*>(in), count);
+		in += count;
+		// The last sequence has literals, but no match.
+		if (in == end) break;
+		if (end - in < 2) return false;
+		size_t offset = in[0] | (in[1] << 8);
+		in += 2;
+		size_t length = (token & 0x0F);
+		if (length == 15 && !get_length(in, end, length)) return false;
+		length += kMinMatch;
+		if (offset == 0 || offset > out.size()) return false;
+		if (out.size() + length > expected) return false;
+		// The copy may overlap the bytes it is producing, which is how a
+		// run of one repeated byte comes out.
+		size_t from = out.size() - offset;
+		if (offset >= length) {
+			out.append(out, from, length);
+		} else {
+			for (size_t i = 0; i < length; ++i) {
+				out.push_back(out[from + i]);
+			}
+		}
+	}
+	return out.size() == expected;
+}
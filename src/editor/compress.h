@@ -0,0 +1,36 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#ifndef EDITOR_COMPRESS_H
+#define EDITOR_COMPRESS_H
+
+#include <cstddef>
+#include <string>
+
+// Squeeze a block of bytes down for storage, then get it back again. This is
+// a plain LZ77 scheme laid out the way LZ4 does it: runs of literal bytes,
+// each followed by a copy of some earlier stretch of the output. It is nowhere
+// near as thorough as deflate, but it runs at memory speed, and source text is
+// repetitive enough that it usually saves more than half.
+namespace Editor {
+std::string compress(const char *data, size_t size);
+// Expand a compressed block, which should come out to exactly this size;
+// return false if the block is damaged.
+bool decompress(const char *data, size_t size, size_t expected, std::string &out);
+} // namespace Editor
+
+#endif // EDITOR_COMPRESS_H
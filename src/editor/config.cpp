@@ -164,18 +164,32 @@ void Editor::Config::load(std::string file_path) {
 	}
 }
 
+const char *Editor::Config::end_of_line() const {
+	switch (_end_of_line) {
+		case CRLF: return "\x0D\x0A";
+		case CR: return "\x0D";
+		default: return "\x0A";
+	}
+}
+
 void Editor::Config::reset() {
 	// Default values for all settings, to be overridden by values specified
 	// in .editorconfig files as we may discover them.
 	_indent_style = TAB;
 	_indent_size = 4;
+	// These settings govern the way we write the file out.
+	_end_of_line = LF;
+	_end_of_line_specified = false;
+	_trim_trailing_whitespace = false;
+	_insert_final_newline = false;
+	_insert_final_newline_specified = false;
+	// The charset tells us how to read a file with no byte order mark, and
+	// how to write a new one.
+	_charset = Charset::UTF8;
+	_byte_order_mark = true;
 	// We don't actually use the rest of these settings, but we'll keep track
 	// of them because they are defined in the specification.
 	_tab_width = 4;
-	_end_of_line = LF;
-	_charset = UTF8;
-	_trim_trailing_whitespace = true;
-	_insert_final_newline = true;
 	_max_line_length = 80;
 }
 
@@ -191,18 +205,22 @@ void Editor::Config::apply(std::string key, std::string val) {
 		if (val == "cr") _end_of_line = CR;
 		else if (val == "lf") _end_of_line = LF;
 		else if (val == "crlf") _end_of_line = CRLF;
+		else return;
+		_end_of_line_specified = true;
 	} else if (key == "charset") {
-		if (val == "utf-8") _charset = UTF8;
-		else if (val == "latin1") _charset = LATIN1;
-		else if (val == "utf-16be") _charset = UTF16BE;
-		else if (val == "utf-16le") _charset = UTF16LE;
-		else if (val == "utf-8-bom") _charset = UTF8BOM;
+		if (val == "utf-8") _charset = Charset::UTF8;
+		else if (val == "latin1") _charset = Charset::Latin1;
+		else if (val == "utf-16be") _charset = Charset::UTF16BE;
+		else if (val == "utf-16le") _charset = Charset::UTF16LE;
+		else if (val == "utf-8-bom") _charset = Charset::UTF8BOM;
 	} else if (key == "trim_trailing_whitespace") {
 		if (val == "true") _trim_trailing_whitespace = true;
 		else if (val == "false") _trim_trailing_whitespace = false;
 	} else if (key == "insert_final_newline") {
 		if (val == "true") _insert_final_newline = true;
 		else if (val == "false") _insert_final_newline = false;
+		else return;
+		_insert_final_newline_specified = true;
 	} else if (key == "max_line_length") {
 		_max_line_length = std::stoul(val, 0, 10);
 	}
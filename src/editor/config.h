@@ -19,6 +19,7 @@
 #define EDITOR_CONFIG_H
 
 #include <string>
+#include "editor/charset.h"
 
 // This is an implementation of the editorconfig standard:
 //     http://www.editorconfig.org/
@@ -32,6 +33,27 @@ public:
 	// Properties which control behaviors that this editor actually implements:
 	char indent_style() const { return _indent_style; }
 	unsigned indent_size() const { return _indent_size; }
+	const char *end_of_line() const;
+	// Did an editorconfig file say which linebreaks to use? If not, a file
+	// should keep the linebreaks it already has.
+	bool end_of_line_specified() const { return _end_of_line_specified; }
+	void set_end_of_line(std::string val) { apply("end_of_line", val); }
+	// Did an editorconfig file ask us to clean up the ends of lines, or of
+	// the file? If not, the file should keep what it already has.
+	bool trim_trailing_whitespace() const { return _trim_trailing_whitespace; }
+	bool insert_final_newline() const { return _insert_final_newline; }
+	bool insert_final_newline_specified() const {
+		return _insert_final_newline_specified;
+	}
+	void set_insert_final_newline(bool val) {
+		apply("insert_final_newline", val? "true": "false");
+	}
+	Charset charset() const { return _charset; }
+	void set_charset(Charset charset) { _charset = charset; }
+	// Should the file begin with the byte order mark its charset calls for?
+	// A new file does, but an old one keeps whatever it began with.
+	bool byte_order_mark() const { return _byte_order_mark; }
+	void set_byte_order_mark(bool val) { _byte_order_mark = val; }
 	// Other properties are supported, as per the standard, but have no effect.
 private:
 	void reset();
@@ -40,9 +62,12 @@ private:
 	unsigned _indent_size;
 	unsigned _tab_width;
 	enum { LF, CRLF, CR } _end_of_line;
-	enum { LATIN1, UTF8, UTF8BOM, UTF16BE, UTF16LE } _charset;
+	bool _end_of_line_specified;
+	Charset _charset;
+	bool _byte_order_mark;
 	bool _trim_trailing_whitespace;
 	bool _insert_final_newline;
+	bool _insert_final_newline_specified;
 	unsigned _max_line_length;
 };
 } // namespace Editor
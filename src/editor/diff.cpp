@@ -0,0 +1,128 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/diff.h"
+#include <algorithm>
+
+namespace {
+// The search costs time proportional to the length of the files times the
+// number of differences, and memory proportional to the square of the
+// number of differences; this keeps both within reason.
+const long kMaxEdits = 1000;
+
+bool myers(const uint64_t *a, long n, const uint64_t *b, long m,
+		std::vector<std::vector<long>> &trace) {
+	// Each round extends the furthest-reaching path on every diagonal k by
+	// one more edit, then follows it along any run of matching lines. The
+	// frontier from each round is kept, so the path can be traced back.
+	long max = std::min(n + m, kMaxEdits);
+	std::vector<long> v(2 * max + 3, 0);
+	long offset = max + 1;
+	for (long d = 0; d <= max; ++d) {
+		for (long k = -d; k <= d; k += 2) {
+			long x;
+			if (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1])) {
+				x = v[offset + k + 1];
+			} else {
+				x = v[offset + k - 1] + 1;
+			}
+			long y = x - k;
+			while (x < n && y < m && a[x] == b[y]) {
+				++x;
+				++y;
+			}
+			v[offset + k] = x;
+			if (x >= n && y >= m) {
+				trace.push_back(v);
+				return true;
+			}
+		}
+		trace.push_back(v);
+	}
+	return false;
+}
+
+void backtrack(long n, long m, const std::vector<std::vector<long>> &trace,
+		size_t base_a, size_t base_b, std::vector<Editor::Hunk> &out) {
+	// Walk back from the end to find the edits in reverse order, merging
+	// adjacent ones into hunks.
+	long offset = (long)(trace.front().size() - 3) / 2 + 1;
+	std::vector<Editor::Hunk> hunks;
+	long x = n, y = m;
+	for (long d = (long)trace.size() - 1; d > 0; --d) {
+		const std::vector<long> &v = trace[d - 1];
+		long k = x - y;
+		long prev_k;
+		if (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1])) {
+			prev_k = k + 1;
+		} else {
+			prev_k = k - 1;
+		}
+		long prev_x = v[offset + prev_k];
+		long prev_y = prev_x - prev_k;
+		// Step back over the matching run, then over the edit itself.
+		while (x > prev_x && y > prev_y) {
+			--x;
+			--y;
+		}
+		Editor::Hunk edit{(size_t)prev_x, (size_t)x, (size_t)prev_y, (size_t)y};
+		if (!hunks.empty() && hunks.back().old_begin == edit.old_end &&
+				hunks.back().new_begin == edit.new_end) {
+			hunks.back().old_begin = edit.old_begin;
+			hunks.back().new_begin = edit.new_begin;
+		} else {
+			hunks.push_back(edit);
+		}
+		x = prev_x;
+		y = prev_y;
+	}
+	for (auto iter = hunks.rbegin(); iter != hunks.rend(); ++iter) {
+		Editor::Hunk h = *iter;
+		h.old_begin += base_a;
+		h.old_end += base_a;
+		h.new_begin += base_b;
+		h.new_end += base_b;
+		out.push_back(h);
+	}
+}
+} // namespace
+
+std::vector<Editor::Hunk> Editor::diff(
+		const std::vector<uint64_t> &before, const std::vector<uint64_t> &after) {
+	std::vector<Hunk> out;
+	size_t head = 0;
+	size_t n = before.size(), m = after.size();
+	while (head < n && head < m && before[head] == after[head]) {
+		++head;
+	}
+	size_t tail = 0;
+	while (tail < n - head && tail < m - head &&
+			before[n - 1 - tail] == after[m - 1 - tail]) {
+		++tail;
+	}
+	long a_len = n - head - tail;
+	long b_len = m - head - tail;
+	if (0 == a_len && 0 == b_len) return out;
+	std::vector<std::vector<long>> trace;
+	if (a_len && b_len &&
+			myers(&before[head], a_len, &after[head], b_len, trace)) {
+		backtrack(a_len, b_len, trace, head, head, out);
+	} else {
+		out.push_back(Hunk{head, n - tail, head, m - tail});
+	}
+	return out;
+}
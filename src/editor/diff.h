@@ -0,0 +1,44 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#ifndef EDITOR_DIFF_H
+#define EDITOR_DIFF_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Compare two versions of a file line by line, each line represented by its
+// hash, and describe the shortest way to turn the old version into the new
+// one as a list of hunks, in order. This is Myers' algorithm, after trimming
+// whatever the versions have in common at either end. Past a certain number
+// of differences, finding the shortest script is no longer worth the time,
+// and we settle for replacing everything between the common ends.
+namespace Editor {
+struct Hunk {
+	// Lines [old_begin, old_end) of the old version are replaced by lines
+	// [new_begin, new_end) of the new one.
+	size_t old_begin;
+	size_t old_end;
+	size_t new_begin;
+	size_t new_end;
+};
+std::vector<Hunk> diff(
+		const std::vector<uint64_t> &before, const std::vector<uint64_t> &after);
+} // namespace Editor
+
+#endif // EDITOR_DIFF_H
@@ -16,20 +16,62 @@
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
 #include "editor/document.h"
+#include "editor/diff.h"
+#include <algorithm>
 #include <cstring>
 #include <exception>
-#include <fstream>
-#include <sstream>
+#include <unordered_set>
 #include <assert.h>
 #include <sys/stat.h>
 
-Editor::Document::Document(std::string path) {
+namespace {
+// How much of a file should we index before we return control to the user?
+// This is many screenfuls of text, at any plausible line length.
+const size_t kFirstBlock = 256 * 1024;
+// Files this large are paged in a window at a time, and can't be edited.
+const size_t kPagedSize = 1024 * 1024 * 1024;
+// How many lines must we delete or replace before we look for space to
+// reclaim, and how much space must be in play before it's worth the trouble?
+const size_t kCompactLines = 4096;
+const size_t kCompactBytes = 4 * 1024 * 1024;
+
+bool compactable(const Editor::Line &line) {
+	// Borrowed lines belong to the mapping and inline lines to themselves.
+	switch (line.storage()) {
+		case Editor::Line::Storage::Heap:
+		case Editor::Line::Storage::Arena: return true;
+		default: return false;
+	}
+}
+
+uint64_t digest(const Editor::LineTree &lines) {
+	// An empty file has no lines at all, but as soon as someone types into
+	// it, it has at least one; once that is undone, it is empty again.
+	static const uint64_t blank = [] {
+		Editor::LineTree tree;
+		tree.push_back(Editor::Line());
+		return tree.digest();
+	}();
+	return lines.empty()? blank: lines.digest();
+}
+
+Editor::Hash contents(const Editor::Mapping &mapping) {
+	Editor::Hash out;
+	if (mapping.valid()) out.update(mapping.data(), mapping.size());
+	return out;
+}
+} // namespace
+
+Editor::Document::Document(std::string path): _path(path) {
 	_lines.clear();
 	_edits.clear();
 	_modified = false;
 	_read_only = false;
-	struct stat sb;
-	if (stat(path.c_str(), &sb)) {
+	// A file which doesn't exist yet has no mode to look at.
+	struct stat sb = {};
+	bool exists = 0 == stat(path.c_str(), &sb);
+	bool regular = exists && S_ISREG(sb.st_mode);
+	if (!exists) {
 		_status = "New";
 		_maxline = append_line("");
 	} else if (S_ISDIR(sb.st_mode)) {
@@ -41,33 +83,569 @@ Editor::Document::Document(std::string path) {
 	} else {
 		_status.clear();
 	}
+	// Whatever the document holds as it comes from the file is the text we
+	// will compare it with to see whether it has been modified.
+	_saved_digest = digest(_lines);
+
+	// Unless the file announces its own charset, the editorconfig tells us
+	// how to read it, and we will write it back out the same way.
+	Config config;
+	config.load(path);
+	_charset = config.charset();
+	// Map the file into memory, then index its lines as slices of the
+	// mapping; we will only copy the lines somebody edits or displays.
+	std::shared_ptr<Mapping> mapping(new Mapping(path, _charset));
+	if (mapping->valid() && mapping->size() >= kPagedSize) {
+		_mapping = mapping;
+		_charset = mapping->charset();
+		_bom = mapping->bom();
+		_pager.reset(new Pager(mapping));
+		_read_only = true;
+		_status = "Indexing 0%";
+		return;
+	}
+	// Keep an eye on the file, in case something else changes it.
+	if (regular) {
+		_disk_info = sb;
+		_watcher.reset(new Watcher(path));
+		if (!_watcher->valid()) _watcher.reset();
+	}
+	if (!mapping->valid()) {
+		if (regular) {
+			follow(path, *mapping);
+			restore_history();
+		}
+		return;
+	}
+	_mapping = mapping;
+	_charset = mapping->charset();
+	_bom = mapping->bom();
+	follow(path, *mapping);
+	// Index enough of the file to fill the screen right away. If there is
+	// more, a worker thread will index the rest while the user reads, and
+	// the document will stay read-only until all of the lines are in.
+	std::vector<Line> lines;
+	size_t loaded = Loader::scan(*mapping, 0, kFirstBlock, lines, _profile);
+	_lines.insert(_lines.size(), std::move(lines));
+	_maxline = _lines.empty()? 0: _lines.size() - 1;
+	_saved_digest = digest(_lines);
+	_disk.update(mapping->data(), loaded);
+	if (loaded < mapping->size()) {
+		_loader.reset(new Loader(mapping, loaded, _disk));
+		_read_only = true;
+		_status = "Loading " + std::to_string(_loader->progress()) + "%";
+	} else {
+		restore_history();
+	}
+}
+
+Editor::Document::Document(std::unique_ptr<Stream> source):
+		_stream(std::move(source)) {
+	_read_only = true;
+	_status = "Reading";
+	stream_more();
+}
+
+void Editor::Document::restore_history() {
+	// The history leads up to the document as it was saved, which may not
+	// be exactly what the file holds, if the save trimmed trailing spaces or
+	// added a final newline; it can only be used if the lines read back in
+	// are the same ones.
+	_edits.restore(_path, _disk.digest(), [this] { return digest(_lines); });
+}
+
+bool Editor::Document::load_more() {
+	if (_pager) return page_more();
+	if (_stream) return stream_more();
+	if (!_loader) return false;
+	std::vector<Line> lines;
+	bool done = _loader->take(lines, _profile);
+	bool more = !lines.empty();
+	line_t index = _lines.size();
+	size_t count = lines.size();
+	_lines.insert(index, std::move(lines));
+	if (more) {
+		_version++;
+		notify(Delta::Kind::Insert, index, 0, count);
+	}
+	_maxline = _lines.empty()? 0: _lines.size() - 1;
+	// Hash each block of lines as it comes in, so that the digest of the
+	// whole file is ready when the last one does, and the first edit won't
+	// mean hashing every line at once.
+	_lines.digest();
+	if (done) {
+		_saved_digest = digest(_lines);
+		_disk = _loader->hash();
+		_loader.reset();
+		_read_only = false;
+		_status.clear();
+		// Now that we know what the file holds, we can tell whether the
+		// history saved with it still applies.
+		restore_history();
+	} else {
+		_status = "Loading " + std::to_string(_loader->progress()) + "%";
+	}
+	return done || more;
+}
+
+void Editor::Document::follow(std::string path, const Mapping &mapping) {
+	// Only plain UTF-8 files can be extended a few bytes at a time; anything
+	// else had to be transcoded as a whole.
+	_follower.reset();
+	if (_charset != Charset::UTF8) return;
+	_follower.reset(new Follower(path, mapping.data(), mapping.size()));
+	_follow_partial = _follower->partial();
+	if (!_follower->valid()) _follower.reset();
+}
+
+bool Editor::Document::page_more() {
+	line_t index = _pager->size();
+	bool done = _pager->poll();
+	size_t count = _pager->size() - index;
+	if (count) {
+		_version++;
+		notify(Delta::Kind::Insert, index, 0, count);
+	}
+	_maxline = _pager->size()? _pager->size() - 1: 0;
+	if (done) {
+		_status = "Read only";
+	} else {
+		_status = "Indexing " + std::to_string(_pager->progress()) + "%";
+	}
+	return done || count;
+}
+
+bool Editor::Document::stream_more() {
+	std::vector<Line> lines;
+	bool more = _stream->read(lines);
+	line_t index = _lines.size();
+	size_t count = lines.size();
+	_lines.insert(index, std::move(lines));
+	if (more) {
+		_version++;
+		notify(Delta::Kind::Insert, index, 0, count);
+	}
+	_maxline = _lines.empty()? 0: _lines.size() - 1;
+	// Hash the new lines while they are few, so that asking whether the
+	// document is modified won't mean hashing the whole stream at once.
+	_lines.digest();
+	if (!_stream->done()) {
+		_status = "Reading " + std::to_string(_lines.size()) + " lines";
+		return more;
+	}
+	// Nothing the stream wrote has been saved anywhere yet, so the document
+	// counts as modified, unless the writer never wrote anything at all.
+	_stream.reset();
+	_read_only = false;
+	_modified = true;
+	_saved_digest = digest(LineTree());
+	_status = modified()? "Modified": "";
+	return true;
+}
+
+bool Editor::Document::refresh() {
+	if (!_watcher || _loader || _saver) return false;
+	if (!_watcher->changed() && !_recheck) return false;
+	struct stat sb;
+	if (stat(_path.c_str(), &sb) || !S_ISREG(sb.st_mode)) return false;
+	if (_recheck) {
+		// This is the file we just wrote, holding the document as of the
+		// save; it is the text on disk from now on.
+		_recheck = false;
+		std::shared_ptr<Mapping> source(new Mapping(_path, _charset));
+		_disk = contents(*source);
+		_disk_info = sb;
+		if (!modified()) {
+			_modified = false;
+			follow(_path, *source);
+		}
+		// If nothing has changed since the save, the history leads up to
+		// exactly this file, so it can be saved along with it.
+		if (_version == _saved_version) {
+			_edits.preserve(_path, _disk.digest(), digest(_lines));
+		}
+		return false;
+	}
+	bool same_file = sb.st_dev == _disk_info.st_dev &&
+			sb.st_ino == _disk_info.st_ino;
+	size_t size = static_cast<size_t>(sb.st_size);
+	size_t old_size = static_cast<size_t>(_disk_info.st_size);
+	if (same_file && size == old_size &&
+			sb.st_mtim.tv_sec == _disk_info.st_mtim.tv_sec &&
+			sb.st_mtim.tv_nsec == _disk_info.st_mtim.tv_nsec) {
+		return false;
+	}
+	// A file which grew without being replaced is presumably a log, which
+	// something is appending to; read only what's new.
+	if (same_file && _follower && size > old_size) {
+		bool more = follow();
+		if (!_follower->truncated()) {
+			if (_mapping) _mapping->acknowledge();
+			_disk_info = sb;
+			return more;
+		}
+	}
+	// Otherwise, read the whole thing again, and see if the text changed.
+	std::shared_ptr<Mapping> source(new Mapping(_path, _charset));
+	Hash disk = contents(*source);
+	_disk_info = sb;
+	if (disk.digest() == _disk.digest()) {
+		if (_mapping) _mapping->acknowledge();
+		if (!modified()) {
+			_modified = false;
+			follow(_path, *source);
+		}
+		return false;
+	}
+	_disk = disk;
+	if (modified()) {
+		_stale = true;
+		_status = "Changed on disk!";
+		return false;
+	}
+	patch(source);
+	follow(_path, *source);
+	return true;
+}
 
-	std::string str;
-	std::ifstream file(path);
-	// We will read every file using LF as delimiter. When reading a Windows
-	// formatted text file, we will then strip the trailing CR.
-	while (std::getline(file, str, '\x0A')) {
-		if (str.back() == '\x0D') str.pop_back();
-		_maxline = append_line(str);
+bool Editor::Document::follow() {
+	// Lines appended to the file can go on the end of the document, as long
+	// as the document still matches what was in the file.
+	if (!_follower || _loader) return false;
+	std::vector<Line> lines;
+	if (!_follower->read(lines, _disk)) return false;
+	line_t index = _lines.size();
+	size_t removed = 0;
+	if (_follow_partial && index > 0) {
+		// The first line finishes the one the file used to end with.
+		index--;
+		_lines.erase(index, index + 1);
+		removed = 1;
 	}
+	_follow_partial = false;
+	size_t count = lines.size();
+	_lines.insert(index, std::move(lines));
+	_maxline = _lines.size() - 1;
+	_saved_digest = digest(_lines);
+	_version++;
+	notify(Delta::Kind::Insert, index, removed, count);
+	return true;
 }
 
-void Editor::Document::Write(std::string path) {
-	std::ofstream file;
-	file.exceptions(std::ios::failbit);
-	try {
-		file.open(path, std::ios::trunc | std::ios::out);
-		for (auto &line: _lines) {
-			file << line << std::endl;
+void Editor::Document::patch(std::shared_ptr<Mapping> source) {
+	// Compare the lines by their hashes, then make the document match the
+	// file one hunk at a time, from the bottom up, so the line numbers of
+	// the hunks still to come stay put. The hunks go into the undo history
+	// together, as a single edit apart from whatever the user did last, so
+	// one undo takes the document back to the way it was.
+	if (_mapping && _mapping->changed()) {
+		// Lines still reading from a file which was rewritten in place have
+		// already changed underneath us, so there is nothing to compare.
+		reread(source);
+		return;
+	}
+	_edits.begin_edit();
+	// Most changes touch only part of a file, so we first match up lines at
+	// either end directly against the file's bytes; only the part between
+	// must be indexed and hashed. Along the way, we profile the new file,
+	// counting the linebreaks of the lines we match.
+	const char *data = source->valid()? source->data(): nullptr;
+	const char *p = data;
+	const char *q = data + (data? source->size(): 0);
+	Profile profile;
+	line_t head = 0;
+	for (auto &line: _lines) {
+		size_t size = line.size();
+		if (p == q || (size_t)(q - p) < size) break;
+		if (memcmp(p, line.data(), size)) break;
+		const char *brk = p + size;
+		auto ending = Profile::EOL::None;
+		if (brk == q) {
+			p = q;
+		} else if (brk[0] == '\x0A') {
+			p = brk + 1;
+			ending = Profile::EOL::LF;
+		} else if (brk[0] == '\x0D' && brk + 1 < q && brk[1] == '\x0A') {
+			p = brk + 2;
+			ending = Profile::EOL::CRLF;
+		} else {
+			break;
+		}
+		profile.line(line, ending);
+		head++;
+	}
+	line_t tail = 0;
+	std::vector<Profile::EOL> endings;
+	while (tail < _lines.size() - head && q > p) {
+		// Find the last line remaining, and set aside its linebreak.
+		const char *end = (q[-1] == '\x0A')? q - 1: q;
+		auto nl = static_cast<const char*>(memrchr(p, '\x0A', end - p));
+		const char *begin = nl? nl + 1: p;
+		size_t size = end - begin;
+		bool cr = size && end[-1] == '\x0D';
+		if (cr) --size;
+		const Line &line = _lines[_lines.size() - 1 - tail];
+		if (line.size() != size || memcmp(begin, line.data(), size)) break;
+		if (end == q) {
+			endings.push_back(Profile::EOL::None);
+		} else {
+			endings.push_back(cr? Profile::EOL::CRLF: Profile::EOL::LF);
 		}
-		file.close();
-		clear_modify();
-	} catch (...) {
-		int local_errno = errno;
-		std::string err = "Failed to write (" + std::to_string(local_errno);
-		err += ": " + std::string(std::strerror(local_errno)) + ")";
-		throw std::runtime_error(err);
+		q = begin;
+		tail++;
+	}
+	std::vector<Line> lines;
+	if (q > p) {
+		// Stop just short of the final linebreak; the scan will find it.
+		Profile middle;
+		Loader::scan(*source, p - data, q - p - 1, lines, middle);
+		profile.merge(middle);
+	}
+	std::vector<uint64_t> before, after;
+	before.reserve(_lines.size() - head - tail);
+	auto old_line = _lines.at(head);
+	for (line_t i = head; i < _lines.size() - tail; ++i, ++old_line) {
+		before.push_back(Hash::of(old_line->data(), old_line->size()));
+	}
+	after.reserve(lines.size());
+	for (auto &line: lines) {
+		after.push_back(Hash::of(line.data(), line.size()));
+	}
+	std::vector<Hunk> hunks = diff(before, after);
+	for (auto iter = hunks.rbegin(); iter != hunks.rend(); ++iter) {
+		std::vector<Line> added(
+				lines.begin() + iter->new_begin, lines.begin() + iter->new_end);
+		line_t first = head + iter->old_begin;
+		line_t last = head + iter->old_end;
+		if (first < last && !added.empty()) {
+			Range span(home(first), end(last - 1));
+			if (!span.empty()) erase(span);
+			size_t last_size = added.back().size();
+			Text text(std::move(added), 0, last_size, source);
+			if (!text.empty()) insert(home(first), text);
+		} else if (first < last) {
+			// Remove the lines along with the linebreak which set them off
+			// from their neighbors, which is the one before them at the end.
+			Range span(home(first), end(last - 1));
+			if (last < _lines.size()) {
+				span = Range(home(first), home(last));
+			} else if (first > 0) {
+				span = Range(end(first - 1), end(last - 1));
+			}
+			if (!span.empty()) erase(span);
+		} else if (first > 0) {
+			// New lines go after the end of the line above them, leaving
+			// the line below where it was, aside from its index.
+			size_t last_size = added.back().size();
+			added.insert(added.begin(), Line());
+			insert(end(first - 1), Text(std::move(added), 0, last_size, source));
+		} else if (!_lines.empty()) {
+			added.emplace_back();
+			insert(home(0), Text(std::move(added), 0, 0, source));
+		} else {
+			size_t last_size = added.back().size();
+			Text text(std::move(added), 0, last_size, source);
+			if (!text.empty()) insert(home(0), text);
+		}
+	}
+	_edits.end_edit();
+	// The lines at the bottom of the file, which the patch left alone, come
+	// last in its profile; a NUL may be anywhere.
+	for (line_t i = tail; i-- > 0;) {
+		profile.line(_lines[_lines.size() - 1 - i], endings[i]);
 	}
+	profile.binary = data && memchr(data, '\0', source->size());
+	_profile = profile;
+	_charset = source->charset();
+	_bom = !source->valid() || source->bom();
+	_modified = false;
+	_saved_digest = digest(_lines);
+	_status.clear();
+}
+
+void Editor::Document::reread(std::shared_ptr<Mapping> source) {
+	// The old text is gone, but the history which led up to it is not, so
+	// we replace the whole document in a single edit, which goes into the
+	// history like any other; undoing it brings back whatever the old lines
+	// held by the time we noticed the change.
+	std::vector<Line> lines;
+	Profile profile;
+	if (source->valid()) {
+		Loader::scan(*source, 0, source->size(), lines, profile);
+	}
+	_edits.begin_edit();
+	Range all(home(), end());
+	if (!all.empty()) erase(all);
+	// The new lines can go on borrowing from the new mapping, which the
+	// document reads from now.
+	_mapping = source->valid()? source: nullptr;
+	if (!lines.empty()) {
+		size_t last_size = lines.back().size();
+		insert(home(), Text(std::move(lines), 0, last_size, _mapping));
+	}
+	_edits.end_edit();
+	_profile = profile;
+	_charset = source->charset();
+	_bom = !source->valid() || source->bom();
+	_modified = false;
+	_saved_digest = digest(_lines);
+	_status.clear();
+}
+
+Editor::Document::Usage Editor::Document::usage() const {
+	// Lines which share storage must only be charged for it once.
+	Usage out;
+	std::unordered_set<const void*> owners;
+	size_t stored = 0;
+	for (auto &line: _lines) {
+		out.lines++;
+		out.text += line.size();
+		switch (line.storage()) {
+			case Line::Storage::Inline: break;
+			case Line::Storage::Borrowed: out.mapped += line.size(); break;
+			default:
+				stored += line.size();
+				if (owners.insert(line.owner()).second) {
+					out.overhead += line.capacity();
+				}
+		}
+	}
+	// Whatever the owners hold beyond the text itself is overhead, as are
+	// the line objects, which the tree packs into arrays.
+	out.overhead -= std::min(out.overhead, stored);
+	out.overhead += out.lines * sizeof(Line);
+	return out;
+}
+
+void Editor::Document::compact() {
+	if (_erased < kCompactLines) return;
+	_erased = 0;
+	// Lines with strings of their own, such as the ones edits leave behind,
+	// cost a string header and a control block apiece, and may have room to
+	// spare besides, so they count as waste along with emptied arena space.
+	size_t live = 0, held = 0;
+	std::unordered_set<const void*> owners;
+	for (auto &line: _lines) {
+		if (!compactable(line)) continue;
+		live += line.size();
+		if (owners.insert(line.owner()).second) {
+			held += line.capacity();
+		}
+	}
+	if (held < kCompactBytes || held < 2 * live) return;
+	// Copy the surviving lines into fresh arena chunks, then rebuild the
+	// tree, which packs its nodes tightly while we are at it. The old
+	// storage is released as soon as no snapshot or undo record refers to it.
+	Arena arena;
+	std::vector<Line> lines;
+	lines.reserve(_lines.size());
+	for (auto &line: _lines) {
+		if (compactable(line)) {
+			lines.emplace_back(line.data(), line.size(), arena);
+		} else {
+			lines.push_back(line);
+		}
+	}
+	_lines.clear();
+	_lines.insert(0, std::move(lines));
+	// The new nodes must be hashed again, and we are idle now anyway.
+	_lines.digest();
+}
+
+std::string Editor::Document::status() const {
+	// An edited document which is back the way it was needs no mention.
+	return (_status == "Modified" && !modified())? std::string(): _status;
+}
+
+bool Editor::Document::modified() const {
+	// The digest only needs hashing again along the paths to edited lines.
+	return _modified && digest(_lines) != _saved_digest;
+}
+
+void Editor::Document::observe(Observer *observer) {
+	_observers.push_back(observer);
+}
+
+void Editor::Document::unobserve(Observer *observer) {
+	auto iter = std::find(_observers.begin(), _observers.end(), observer);
+	if (iter != _observers.end()) {
+		_observers.erase(iter);
+	}
+}
+
+void Editor::Document::save(std::string path, const Config &config) {
+	if (_loader) {
+		throw std::runtime_error("Failed to write (still loading)");
+	}
+	if (_stream) {
+		throw std::runtime_error("Failed to write (still reading)");
+	}
+	if (_pager) {
+		throw std::runtime_error("Failed to write (file is too large)");
+	}
+	// Something else changed the file after we began editing; make sure the
+	// user means to overwrite it.
+	if (_stale && path == _path) {
+		_stale = false;
+		throw std::runtime_error(
+				"Failed to write (file changed on disk; save again to overwrite)");
+	}
+	// Lines which are slices of a file something else has rewritten in place
+	// no longer hold the text we read, and must not be written anywhere.
+	if (_mapping && _mapping->changed()) {
+		throw std::runtime_error("Failed to write (file changed on disk)");
+	}
+	// Only one save at a time, please; let any previous save finish first.
+	if (_saver) {
+		std::string message;
+		collect_save(message);
+	}
+	// The new file replaces the old one by rename, so the lines which are
+	// still slices of our mapping remain valid: they refer to the old file,
+	// which lingers until we unmap it.
+	Config format(config);
+	format.set_charset(_charset);
+	format.set_byte_order_mark(_bom);
+	// Without a setting, a file keeps the linebreaks most of its lines had.
+	if (!config.end_of_line_specified() && _profile.crlf > _profile.lf) {
+		format.set_end_of_line("crlf");
+	}
+	// Unless told otherwise, the file ends the way it did when we read it;
+	// a brand new file gets the customary trailing newline.
+	if (!config.insert_final_newline_specified()) {
+		bool ended = _profile.lines == 0 || _profile.last != Profile::EOL::None;
+		format.set_insert_final_newline(ended);
+	}
+	_saver.reset(new Saver(snapshot(), path, format));
+	_saving_path = path;
+	_saving_digest = digest(_lines);
+	_follower.reset();
+	_saved_version = _version;
+	_status = "Saving";
+}
+
+bool Editor::Document::collect_save(std::string &message) {
+	if (!_saver) return false;
+	bool good = _saver->finish(message);
+	_saver.reset();
+	// If the user went on editing while the save was in progress, the
+	// document is still modified relative to the file we wrote.
+	if (good && _version == _saved_version) {
+		_modified = false;
+	}
+	// From now on, the file we just wrote is the one to keep an eye on.
+	if (good) {
+		_saved_digest = _saving_digest;
+		if (_saving_path != _path || !_watcher) {
+			_path = _saving_path;
+			_watcher.reset(new Watcher(_path));
+			if (!_watcher->valid()) _watcher.reset();
+		}
+		_stale = false;
+		_recheck = true;
+	}
+	_status = _modified? "Modified": "";
+	return good;
 }
 
 Editor::location_t Editor::Document::home() {
@@ -85,16 +663,19 @@ Editor::location_t Editor::Document::home(line_t index) {
 
 Editor::location_t Editor::Document::end(line_t index) {
 	if (index > _maxline) index = _maxline;
-	assert(index < _lines.size());
-	location_t loc = {index, _lines[index].size()};
+	location_t loc = {index, line(index).size()};
 	return loc;
 }
 
 Editor::location_t Editor::Document::next_char(location_t loc) {
-	const std::string &text = _lines[loc.line];
+	const Line &text = line(loc.line);
 	if (loc.offset == text.size()) {
 		return (loc.line < _maxline)? home(loc.line + 1): end();
 	}
+	if (text.ascii()) {
+		loc.offset++;
+		return loc;
+	}
 	// If this char begins a multibyte sequence, attempt to consume the number
 	// of continuation bytes which ought to follow it.
 	char ch = text[loc.offset++];
@@ -119,7 +700,11 @@ Editor::location_t Editor::Document::prev_char(location_t loc) {
 	// byte could feasibly serve as a member of that sequence, jump back to the
 	// beginning of the sequence; otherwise return it on its own, since it is
 	// an erroneous character encoding.
-	const std::string &text = _lines[loc.line];
+	const Line &text = line(loc.line);
+	if (text.ascii()) {
+		loc.offset--;
+		return loc;
+	}
 	offset_t scan = --loc.offset;
 	while (0x80 == (text[scan] & 0xC0)) {
 		--scan;
@@ -135,7 +720,7 @@ Editor::location_t Editor::Document::prev_char(location_t loc) {
 
 Editor::Range Editor::Document::find(std::string needle, location_t loc) {
 	do {
-		loc.offset = _lines[loc.line].find(needle, loc.offset);
+		loc.offset = line(loc.line).find(needle, loc.offset);
 		if (loc.offset != std::string::npos) {
 			location_t match = {loc.line, loc.offset + needle.size()};
 			return Range(loc, sanitize(match));
@@ -145,13 +730,100 @@ Editor::Range Editor::Document::find(std::string needle, location_t loc) {
 	return Range(end(), end());
 }
 
-const std::string &Editor::Document::line(line_t index) const {
+size_t Editor::Document::replace_all(std::string needle, std::string text) {
+	if (needle.empty() || _read_only) return 0;
+	if (needle.find('\n') != std::string::npos) return 0;
+	if (text.find('\n') != std::string::npos) return 0;
+	// Scan the document once for matches, then splice them all at once.
+	// Every splice shares the same copy of the replacement.
+	Line replacement(text);
+	std::vector<Splice> edits;
+	line_t index = 0;
+	for (auto &line: _lines) {
+		size_t pos = line.find(needle, 0);
+		while (pos != std::string::npos) {
+			edits.push_back({index, pos, pos + needle.size(), replacement});
+			pos = line.find(needle, pos + needle.size());
+		}
+		index++;
+	}
+	splice(edits);
+	return edits.size();
+}
+
+void Editor::Document::splice(const std::vector<Splice> &edits) {
+	if (edits.empty() || !attempt_modify()) return;
+	// Build the new text of each line the edits touch, walking through the
+	// lines in order; nothing changes until the walk is done, since changing
+	// a line would invalidate the walk. Each line goes into the undo history
+	// as the span from its first edit to the end of its last, so a long line
+	// with one small change does not cost a copy of the whole line.
+	struct Change {
+		line_t index;
+		offset_t begin;
+		offset_t end;
+		std::string text;
+	};
+	std::vector<Change> changes;
+	auto iter = _lines.at(edits.front().line);
+	line_t index = edits.front().line;
+	size_t i = 0;
+	while (i < edits.size() && index < _lines.size()) {
+		const Line &line = *iter;
+		Change change = {index, edits[i].begin, 0, std::string()};
+		offset_t done = 0;
+		for (; i < edits.size() && edits[i].line == index; ++i) {
+			offset_t begin = std::max(done, std::min(edits[i].begin, line.size()));
+			offset_t end = std::max(begin, std::min(edits[i].end, line.size()));
+			change.text.append(line.data() + done, begin - done);
+			change.text.append(edits[i].text.data(), edits[i].text.size());
+			done = end;
+		}
+		change.end = done;
+		change.text.append(line.data() + done, line.size() - done);
+		change.begin = std::min(change.begin, line.size());
+		changes.push_back(std::move(change));
+		if (i == edits.size()) break;
+		while (index < edits[i].line && index < _lines.size()) {
+			++iter;
+			++index;
+		}
+	}
+	_edits.begin_edit();
+	for (auto &change: changes) {
+		const Line &old = _lines[change.index];
+		size_t after = old.size() - change.end;
+		size_t inserted = change.text.size() - after - change.begin;
+		location_t begin(change.index, change.begin);
+		if (change.end > change.begin) {
+			_edits.erase(Range(begin, location_t(change.index, change.end)),
+					Text(std::string(old.data() + change.begin,
+					change.end - change.begin)));
+		}
+		if (inserted) {
+			location_t end(change.index, change.begin + inserted);
+			_edits.insert(Range(begin, end));
+		}
+		if (change.end == change.begin && !inserted) continue;
+		update_line(change.index, std::move(change.text));
+		notify(Delta::Kind::Insert, change.index, 1, 1);
+	}
+	_edits.end_edit();
+}
+
+Editor::Line Editor::Document::line(line_t index) const {
+	if (_pager) return index < _pager->size()? _pager->line(index): _blank;
 	return index < _lines.size()? _lines[index]: _blank;
 }
 
+bool Editor::Document::ascii(line_t index) const {
+	return line(index).ascii();
+}
+
 char32_t Editor::Document::codepoint(location_t loc) const {
-	auto iter = _lines[loc.line].begin() + loc.offset;
-	char ch = *iter;
+	const Line &text = line(loc.line);
+	offset_t index = loc.offset;
+	char ch = text[index];
 	// we assume shorter sequences occur more frequently, and we'll do a quick
 	// exit for the most common case, which is a 7-bit ASCII character.
 	if (0 == (ch & 0x80)) {
@@ -183,7 +855,7 @@ char32_t Editor::Document::codepoint(location_t loc) const {
 	// Look for the continuation characters we expect and decode the full
 	// character value.
 	while (continuations--) {
-		ch = *++iter;
+		ch = text[++index];
 		// detect broken sequences with too few continuation bytes
 		if ((ch & 0xC0) != 0x80) return replacement_character;
 		out = (out << 6) | (ch & 0x3F);
@@ -192,18 +864,27 @@ char32_t Editor::Document::codepoint(location_t loc) const {
 	return (out >= minimum && out <= 0x10FFFF)? out: replacement_character;
 }
 
-std::string Editor::Document::text(const Range &span) const {
-	std::stringstream out;
-	location_t loc = span.begin();
+Editor::Text Editor::Document::text(const Range &span) const {
+	size_t count = _pager? _pager->size(): _lines.size();
+	if (0 == count) return Text();
+	location_t begin = span.begin();
 	location_t end = span.end();
-	std::string chunk = substr_to_end(loc);
-	while (loc.line < end.line) {
-		out << chunk << '\n';
-		chunk = _lines[++loc.line];
-		loc.offset = 0;
+	line_t last = std::min(end.line, count - 1);
+	std::vector<Line> lines;
+	if (begin.line <= last) {
+		lines.reserve(last - begin.line + 1);
+	}
+	if (_pager) {
+		for (line_t i = begin.line; i <= last; ++i) {
+			lines.push_back(_pager->line(i));
+		}
+	} else if (begin.line <= last) {
+		auto iter = _lines.at(begin.line);
+		for (line_t i = begin.line; i <= last; ++i, ++iter) {
+			lines.push_back(*iter);
+		}
 	}
-	out << chunk.substr(0, end.offset - loc.offset);
-	return out.str();
+	return Text(std::move(lines), begin.offset, end.offset, _mapping);
 }
 
 Editor::location_t Editor::Document::erase(const Range &chars) {
@@ -215,10 +896,11 @@ Editor::location_t Editor::Document::erase(const Range &chars) {
 	location_t end = sanitize(chars.end());
 	std::string suffix = substr_to_end(end);
 	size_t index = begin.line;
-	auto beginter = _lines.begin();
-	_lines.erase(beginter + begin.line + 1, beginter + end.line + 1);
+	_erased += end.line - begin.line;
+	_lines.erase(begin.line + 1, end.line + 1);
 	_maxline = _lines.size() - 1;
 	update_line(index, prefix + suffix);
+	notify(Delta::Kind::Erase, index, end.line - index + 1, 1);
 	return location_t(index, prefix.size());
 }
 
@@ -227,54 +909,73 @@ Editor::location_t Editor::Document::insert(location_t begin, char ch) {
 	location_t loc = begin;
 	if (!attempt_modify()) return loc;
 	if (loc.line < _lines.size()) {
-		std::string text = _lines[loc.line];
+		std::string text = _lines[loc.line].str();
 		text.insert(loc.offset, 1, ch);
 		update_line(loc.line, text);
 		loc.offset++;
+		notify(Delta::Kind::Insert, loc.line, 1, 1);
 	} else {
 		loc.line = append_line(std::string(1, ch));
 		loc.offset = 1;
+		notify(Delta::Kind::Insert, loc.line, 0, 1);
 	}
 	_edits.insert(Range(begin, loc));
 	return loc;
 }
 
 Editor::location_t Editor::Document::insert(location_t cur, std::string text) {
+	return insert(cur, Text(std::move(text)));
+}
+
+Editor::location_t Editor::Document::insert(location_t cur, const Text &text) {
 	sanitize(&cur);
 	location_t loc = cur;
 	if (!attempt_modify()) return loc;
 
-	std::string suffix;
+	// Split this line apart around the insertion point. The first line of
+	// the text joins the prefix, the last line joins the suffix, and all the
+	// lines in between go in as they are.
+	std::string prefix, suffix;
+	size_t removed = 1;
 	if (loc.line < _lines.size()) {
-		// Split this line apart around the insertion point. We will insert
-		// the new text in between these halves. We will temporarily delete
-		// the suffix from its line, since we're likely to be appending more
-		// text for a while, but we'll append the suffix back on at the end.
+		prefix = substr_from_home(loc);
 		suffix = substr_to_end(loc);
-		update_line(loc.line, substr_from_home(loc));
 	} else {
 		loc.line = append_line(std::string());
+		removed = 0;
 	}
-
-	// Search the text for linebreaks. Every time we find one, we'll
-	// cut all the chars from our search position to the linebreak and
-	// append them to the current line. Then we'll insert a new, blank
-	// line, which will become the new current line. When we're
-	// finally out of linebreaks, we'll concatenate whatever is left
-	// of the text with our original suffix and append that to the
-	// current line. If there were no linebreaks at all, this will
-	// simply be the original line we started on.
-	size_t startoff = 0, endoff = 0;
-	while ((endoff = text.find('\n', startoff)) != std::string::npos) {
-		append_to_line(loc.line++, text.substr(startoff, endoff-startoff));
-		insert_line(loc.line, "");
-		loc.offset = 0;
-		startoff = endoff + 1;
+	Text::piece first = text.line(0);
+	prefix.append(first.data, first.size);
+	size_t count = text.lines();
+	if (count == 1) {
+		loc.offset = prefix.size();
+		update_line(loc.line, prefix + suffix);
+		notify(Delta::Kind::Insert, loc.line, removed, 1);
+		_edits.insert(Range(cur, loc));
+		return loc;
 	}
-
-	append_to_line(loc.line, text.substr(startoff, endoff));
-	loc.offset = _lines[loc.line].size();
-	append_to_line(loc.line, suffix);
+	update_line(loc.line, prefix);
+	// Lines from some other document may be slices of its mapping, which
+	// could go away while we still need them, so we must copy those. All the
+	// new lines go into the tree in a single splice.
+	bool borrowed = text.borrows_only(_mapping);
+	Arena arena;
+	std::vector<Line> lines;
+	lines.reserve(count - 1);
+	for (size_t i = 1; i + 1 < count; ++i) {
+		Line line = text.share(i);
+		if (!borrowed && !line.owned()) {
+			line = Line(line.data(), line.size(), arena);
+		}
+		lines.push_back(std::move(line));
+	}
+	Text::piece last = text.line(count - 1);
+	lines.emplace_back(std::string(last.data, last.size) + suffix);
+	_lines.insert(loc.line + 1, std::move(lines));
+	_maxline = _lines.size() - 1;
+	notify(Delta::Kind::Insert, loc.line, removed, count);
+	loc.line += count - 1;
+	loc.offset = last.size;
 	_edits.insert(Range(cur, loc));
 	return loc;
 }
@@ -283,58 +984,68 @@ Editor::location_t Editor::Document::split(location_t loc) {
 	if (!attempt_modify()) return loc;
 	sanitize(&loc);
 	_edits.split(loc);
-	std::string text = line(loc.line);
+	std::string text = substr_to_end(location_t(loc.line, 0));
 	update_line(loc.line, text.substr(0, loc.offset));
 	loc.line++;
 	insert_line(loc.line, text.substr(loc.offset, std::string::npos));
 	loc.offset = 0;
+	notify(Delta::Kind::Split, loc.line - 1, 1, 2);
 	return loc;
 }
 
 std::string Editor::Document::substr_from_home(const location_t &loc) {
-	return _lines[loc.line].substr(0, loc.offset);
+	const Line &text = line(loc.line);
+	return std::string(text.data(), std::min(text.size(), loc.offset));
 }
 
 std::string Editor::Document::substr_to_end(const location_t &loc) const {
-	std::string text = _lines[loc.line];
-	return text.substr(std::min(text.size(), loc.offset), std::string::npos);
+	const Line &text = line(loc.line);
+	offset_t begin = std::min(text.size(), loc.offset);
+	return std::string(text.data() + begin, text.size() - begin);
 }
 
 void Editor::Document::update_line(line_t index, std::string text) {
 	if (index < _lines.size()) {
-		_lines[index] = text;
+		// The line it replaces is as good as erased.
+		_erased++;
+		_lines.set(index, text);
 	} else {
-		_lines.emplace_back(text);
+		_lines.push_back(text);
 	}
 }
 
-void Editor::Document::insert_line(line_t index, std::string text) {
-	_lines.emplace(_lines.begin() + index, text);
+void Editor::Document::insert_line(line_t index, Line text) {
+	_lines.insert(index, std::move(text));
 	_maxline = _lines.size() - 1;
 }
 
 Editor::line_t Editor::Document::append_line(std::string text) {
 	_maxline = _lines.size();
-	_lines.emplace_back(text);
+	_lines.push_back(text);
 	return _maxline;
 }
 
 void Editor::Document::append_to_line(line_t index, std::string suffix) {
-	update_line(index, _lines[index] + suffix);
+	update_line(index, _lines[index].str() + suffix);
 }
 
 void Editor::Document::push_to_line(line_t index, std::string prefix) {
-	update_line(index, prefix + _lines[index]);
+	update_line(index, prefix + _lines[index].str());
+}
+
+void Editor::Document::notify(
+		Delta::Kind kind, line_t index, size_t removed, size_t added) {
+	Delta delta{kind, _version, index, removed, added};
+	for (auto observer: _observers) {
+		observer->changed(delta);
+	}
 }
 
 Editor::location_t Editor::Document::sanitize(const location_t &loc) {
 	// Verify that this location refers to a real place.
 	// Fix it if either of its dimensions would be out-of-bounds.
-	line_t index = std::min(loc.line, _lines.size()-1);
-	offset_t offset = 0;
-	if (!_lines.empty()) {
-		offset = std::min(loc.offset, _lines[index].size());
-	}
+	line_t index = std::min(loc.line, _maxline);
+	offset_t offset = std::min(loc.offset, line(index).size());
 	return location_t(index, offset);
 }
 
@@ -344,15 +1055,15 @@ void Editor::Document::sanitize(location_t *loc) {
 
 bool Editor::Document::attempt_modify() {
 	if (!_modified && !_read_only) {
+		// Lines still borrowing from the file would change along with it if
+		// something rewrote it in place, and the next save would write out
+		// whatever they held then; once the user has edits to lose, the
+		// lines must hold still.
+		if (_mapping) _mapping->detach();
 		_modified = true;
-		_status = "Modified";
+		_follower.reset();
+		if (!_saver) _status = "Modified";
 	}
+	if (_modified) _version++;
 	return _modified;
 }
-
-void Editor::Document::clear_modify() {
-	if (_modified) {
-		_modified = false;
-		_status.clear();
-	}
-}
@@ -21,8 +21,23 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include <sys/stat.h>
+#include "editor/config.h"
+#include "editor/follower.h"
 #include "editor/coordinates.h"
 #include "editor/changelist.h"
+#include "editor/hash.h"
+#include "editor/linetree.h"
+#include "editor/loader.h"
+#include "editor/mapping.h"
+#include "editor/observer.h"
+#include "editor/pager.h"
+#include "editor/profile.h"
+#include "editor/saver.h"
+#include "editor/snapshot.h"
+#include "editor/stream.h"
+#include "editor/text.h"
+#include "editor/watcher.h"
 
 // A document breaks a text buffer into lines, then maps those lines onto an
 // infinite plane of equally sized character cells.
@@ -31,9 +46,73 @@ class Document {
 public:
 	Document() {}
 	Document(std::string path);
-	void Write(std::string path);
-	std::string status() const { return _status; }
-	bool modified() const { return _modified; }
+	// Read the document from a pipe instead, as the text comes in. It has no
+	// file until the user saves it somewhere.
+	Document(std::unique_ptr<Stream> source);
+	// Begin writing a snapshot of the document to the file at this path in
+	// the background. When the save has finished, collect its outcome: true
+	// if the file was written, false if the message explains the error.
+	void save(std::string path, const Config &config);
+	bool saving() const { return _saver.get() != nullptr; }
+	bool save_finished() const { return _saver && _saver->done(); }
+	bool collect_save(std::string &message);
+	// The charset the file was read in, which is how it will be written.
+	Charset charset() const { return _charset; }
+	// What did we learn about the file while loading it? A file which used
+	// CRLF linebreaks for most of its lines will keep them, unless its
+	// editorconfig says otherwise.
+	const Profile &profile() const { return _profile; }
+	// Is a worker still indexing the rest of the file? If so, collect the
+	// lines it has found so far, and return true if there were any. Files
+	// too large to load are paged instead, and remain read-only; a document
+	// read from a stream stays read-only until the writer is done.
+	bool loading() const {
+		return _loader || _stream || (_pager && _pager->indexing());
+	}
+	bool load_more();
+	// Has something else changed the file since we read it? Until the
+	// document is edited, anything appended to the file will be appended to
+	// the document too, the way tail -f would show it, and a file rewritten
+	// some other way is compared line by line with the document, which is
+	// patched to match; the lines which did not change stay put, and the
+	// patch can be undone like any other edit. Lines which were still slices
+	// of a file rewritten in place have nothing left to compare, so the whole
+	// text is replaced instead, in one edit all the same. The document takes
+	// on the new file's charset and profile either way. A modified document
+	// is left alone, but the next save will warn before overwriting the new
+	// file. Return true if the document changed.
+	bool refresh();
+	// How much memory is the document using? We count the lines, the bytes
+	// of text in them, how much of that text is still read from the mapped
+	// file, and everything else we have allocated to hold it all.
+	struct Usage {
+		size_t lines = 0;
+		size_t text = 0;
+		size_t mapped = 0;
+		size_t overhead = 0;
+	};
+	Usage usage() const;
+	// Large deletions may leave arena chunks pinned by a few surviving
+	// lines, and many edits leave lines scattered about the heap, one string
+	// apiece. While the user is idle, copy them all somewhere compact, so
+	// the old storage can go back to the system.
+	void compact();
+	// Every change to the document's text gives it a new version number. A
+	// snapshot captures the current version, and stays the same forever.
+	unsigned long version() const { return _version; }
+	Snapshot snapshot() const { return Snapshot(_lines, _mapping, _version); }
+	// Observers hear about each change to the lines as it happens, tagged
+	// with the version it produced.
+	void observe(Observer *observer);
+	void unobserve(Observer *observer);
+	std::string status() const;
+	// Can the document be edited right now? It can't while it is still
+	// loading, nor if it came from something other than a regular file.
+	bool read_only() const { return _read_only; }
+	// Does the document differ from the file as last read or saved? Undoing
+	// every edit since then puts the document back the way it was, and it
+	// no longer needs saving.
+	bool modified() const;
 	bool can_undo() const { return _edits.can_undo(); }
 	bool can_redo() const { return _edits.can_redo(); }
 	location_t undo(Update &update) { return _edits.undo(*this, update); }
@@ -56,13 +135,21 @@ public:
 	location_t prev_char(location_t loc);
 	// Where is the next occurrence of the specified string?
 	Range find(std::string text, location_t begin);
+	// Replace every occurrence of one string with another, all as a single
+	// edit, and return the number of replacements. Neither string may span
+	// more than one line, and a read-only document is left as it is.
+	size_t replace_all(std::string needle, std::string text);
 
-	// Get the raw text of the indexed source line.
-	const std::string &line(line_t index) const;
+	// Get the raw text of the indexed source line. A line is only a small
+	// handle on its text, and a paged file may let go of its copy at any
+	// time, so we hand out a line of the caller's own.
+	Line line(line_t index) const;
+	// Is every character on this line a single byte?
+	bool ascii(line_t index) const;
 	// Get a specific codepoint.
 	char32_t codepoint(location_t) const;
-	// Retrieve the text within the range as a contiguous string.
-	std::string text(const Range &span) const;
+	// Retrieve the text within the range, sharing the document's lines.
+	Text text(const Range &span) const;
 
 	// Remove the text within the range.
 	location_t erase(const Range &span);
@@ -70,35 +157,93 @@ public:
 	// returning the end of the inserted text.
 	location_t insert(location_t loc, char ch);
 	location_t insert(location_t loc, std::string text);
+	location_t insert(location_t loc, const Text &text);
 	// Split this character's line in half, returning its position at
 	// the beginning of the newly-created following line.
 	location_t split(location_t loc);
+	// Make many small edits in one pass, as one edit for the undo history.
+	// Each replaces a span of one line with some text, which must not hold
+	// a linebreak; the spans must come in document order, not overlapping.
+	struct Splice {
+		line_t line;
+		offset_t begin;
+		offset_t end;
+		Line text;
+	};
+	void splice(const std::vector<Splice> &edits);
 
 private:
 	std::string substr_to_end(const location_t &loc) const;
 	std::string substr_from_home(const location_t &loc);
 	void update_line(line_t index, std::string text);
-	void insert_line(line_t index, std::string text);
+	void insert_line(line_t index, Line text);
 	void push_to_line(line_t index, std::string prefix);
 	void append_to_line(line_t index, std::string suffix);
 	line_t append_line(std::string text);
 	void sanitize(location_t *loc);
 	location_t sanitize(const location_t &loc);
 	bool attempt_modify();
-	void clear_modify();
+	void restore_history();
+	bool page_more();
+	bool stream_more();
+	void follow(std::string path, const Mapping &mapping);
+	bool follow();
+	void patch(std::shared_ptr<Mapping> source);
+	void reread(std::shared_ptr<Mapping> source);
+	void notify(Delta::Kind kind, line_t index, size_t removed, size_t added);
 
-	std::string _blank;
-	std::vector<std::string> _lines;
+	Line _blank;
+	LineTree _lines;
+	// the file our unedited lines are still reading from, if any
+	std::shared_ptr<Mapping> _mapping;
+	// how the file was encoded, and how it will be written again
+	Charset _charset = Charset::UTF8;
+	bool _bom = true;
+	Profile _profile;
+	// the worker indexing the rest of a large file, if still in progress
+	std::unique_ptr<Loader> _loader;
+	// or, for a file too large to load at all, the window onto it
+	std::unique_ptr<Pager> _pager;
+	// or, for text arriving through a pipe, the end we are reading from
+	std::unique_ptr<Stream> _stream;
+	// the file may still be growing; does it end with an unfinished line?
+	std::unique_ptr<Follower> _follower;
+	bool _follow_partial = false;
+	// the file we read, or last saved, and what it held at the time: the
+	// hash of its text lets us ignore writes which leave the text as it was
+	std::string _path;
+	std::unique_ptr<Watcher> _watcher;
+	struct stat _disk_info = {};
+	Hash _disk;
+	// has the file changed under a modified document, or have we just saved
+	// it, so the file we find next is our own?
+	bool _stale = false;
+	bool _recheck = false;
+	std::string _saving_path;
 	line_t _maxline = 0;	// ubound, not size
+	// how many lines have we deleted since we last looked for arena space
+	// which might be reclaimed?
+	size_t _erased = 0;
 
 	// is the user allowed to make changes in this document?
 	bool _read_only = false;
-	// has the document been edited since it was last read?
+	// has the document been edited since it was last read, and what was the
+	// digest of its lines then? what was it when the current save began?
 	bool _modified = false;
+	uint64_t _saved_digest = 0;
+	uint64_t _saving_digest = 0;
+	// how many changes have we made, and how many had we made as of the
+	// snapshot currently being saved?
+	unsigned long _version = 0;
+	unsigned long _saved_version = 0;
 	// what is our user-friendly summary of the file state?
 	std::string _status;
 	// record of all the edits made to this document
 	ChangeList _edits;
+	// the worker writing a snapshot to disk, if a save is in progress
+	std::unique_ptr<Saver> _saver;
+	// everyone who wants to know when the lines change
+	std::vector<Observer*> _observers;
 };
 } // namespace Editor
 
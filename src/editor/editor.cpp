@@ -29,21 +29,33 @@
 #include "search/dialog.h"
 
 Editor::View::View():
-		_syntax(Syntax::lookup("")) {
+		_syntax(Syntax::lookup("")),
+		_styles(_syntax) {
 	// new blank buffer
+	_doc.observe(this);
 }
 
 Editor::View::View(std::string targetpath):
 		_targetpath(targetpath),
 		_doc(targetpath),
-		_syntax(Syntax::lookup(targetpath)) {
+		_syntax(Syntax::lookup(targetpath)),
+		_styles(_syntax) {
 	_config.load(targetpath);
+	_doc.observe(this);
+}
+
+Editor::View::View(std::string title, std::unique_ptr<Stream> source):
+		_title(title),
+		_doc(std::move(source)),
+		_syntax(Syntax::lookup("")),
+		_styles(_syntax) {
+	_doc.observe(this);
 }
 
 void Editor::View::activate(UI::Frame &ctx) {
 	// Set the title according to the target path
 	if (_targetpath.empty()) {
-		ctx.set_title("Untitled");
+		ctx.set_title(_title.empty()? "Untitled": _title);
 	} else {
 		ctx.set_title(Path::display(_targetpath));
 	}
@@ -91,6 +103,7 @@ bool Editor::View::process(UI::Frame &ctx, int ch) {
 		case Control::ToLine: ctl_toline(ctx); break;
 		case Control::Find: ctl_find(ctx); break;
 		case Control::Replace: ctl_replace(ctx); break;
+		case Control::ReplaceAll: ctl_replace_all(ctx); break;
 		case Control::FindNext: ctl_find_next(ctx); break;
 		case Control::Undo: ctl_undo(ctx); break;
 		case Control::Redo: ctl_redo(ctx); break;
@@ -126,6 +139,70 @@ bool Editor::View::process(UI::Frame &ctx, int ch) {
 	return true;
 }
 
+bool Editor::View::poll(UI::Frame &ctx) {
+	// If a background save has finished, tell the user how it went.
+	if (_doc.save_finished()) {
+		finish_save(ctx);
+	}
+	// While the document is still loading, pick up the newly indexed lines
+	// and paint whatever part of them has come into view. Otherwise, pick up
+	// whatever has changed in the file; this is also a quiet moment, and a
+	// good time to tidy up after big deletions.
+	if (!_doc.loading()) {
+		refresh(ctx);
+		_doc.compact();
+		return true;
+	}
+	if (_doc.load_more()) {
+		ctx.repaint();
+	}
+	set_status(ctx);
+	return true;
+}
+
+void Editor::View::refresh(UI::Frame &ctx) {
+	// If the cursor was sitting on the last line, keep it there as the file
+	// grows, so the newest lines stay in view.
+	bool follow_edge = _selection.empty() && _cursor.line == _doc.maxline();
+	_tracking = true;
+	bool changed = _doc.refresh();
+	_tracking = false;
+	if (!changed) {
+		set_status(ctx);
+		return;
+	}
+	if (follow_edge) {
+		move_cursor(_doc.end());
+	} else {
+		_cursor.offset = std::min(_cursor.offset, _doc.end(_cursor).offset);
+		_selection.reset(_anchor = _cursor);
+	}
+	postprocess(ctx);
+	ctx.repaint();
+}
+
+void Editor::View::changed(const Delta &delta) {
+	_styles.changed(delta);
+	// A change which leaves the line count alone only needs the lines it
+	// touched repainted; anything else shifts every line below it.
+	if (delta.added == delta.removed) {
+		for (size_t i = 0; i < delta.added; ++i) {
+			_update.at(delta.index + i);
+		}
+	} else {
+		_update.forward(location_t(delta.index, 0));
+	}
+	if (!_tracking || _cursor.line < delta.index) return;
+	if (_cursor.line >= delta.index + delta.removed) {
+		_cursor.line = _cursor.line + delta.added - delta.removed;
+	} else if (delta.added) {
+		// The cursor's line was replaced; stay as close to it as we can.
+		_cursor.line = std::min(_cursor.line, delta.index + delta.added - 1);
+	} else {
+		_cursor.line = delta.index;
+	}
+}
+
 void Editor::View::set_help(UI::HelpBar::Panel &panel) {
 	panel.cut();
 	panel.copy();
@@ -151,6 +228,15 @@ bool Editor::View::is_modified() const {
 	return _doc.modified();
 }
 
+bool Editor::View::finish_save(UI::Frame &ctx) {
+	if (!_doc.saving()) return true;
+	std::string message;
+	bool good = _doc.collect_save(message);
+	ctx.show_result(message);
+	set_status(ctx);
+	return good;
+}
+
 void Editor::View::postprocess(UI::Frame &ctx) {
 	reveal_cursor();
 	if (_update.has_dirty()) {
@@ -163,34 +249,23 @@ void Editor::View::paint_line(WINDOW *dest, row_t v, State state) {
 	size_t index = v + _scroll.v;
 	if (!_update.is_dirty(index)) return;
 	wmove(dest, (int)v, 0);
-	const std::string &text = _doc.line(index);
-
-	std::vector<int> style(text.size());
-	static Regex trailing_space("[[:space:]]+$");
-	Regex::Match m = trailing_space.find(text);
-	if (!m.empty()) {
-		for (size_t i= m.begin; i < m.end; ++i) {
-			style[i] = UI::Colors::error();
-		}
-	}
-	for (auto &token: Syntax::parse(_syntax, text)) {
-		for (size_t i = token.begin; i < token.end; ++i) {
-			style[i] = token.style();
-		}
-	}
-
+	const Line &text = _doc.line(index);
 	bool active = state != State::Inactive;
+	const std::vector<Styles::Run> *runs = nullptr;
+	if (active) runs = &_styles.runs(index, text);
+	size_t run = 0;
 	unsigned hoff = _scroll.h;
 	column_t h = 0;
 	unsigned width = _width + hoff;
-	size_t style_index = 0;
-	for (char ch: text) {
+	for (size_t i = 0; i < text.size(); ++i) {
 		if (h == width) break;
-		if (active) {
-			wattrset(dest, style[style_index++]);
+		if (runs && (i == 0 || i == (*runs)[run].end)) {
+			if (i > 0) run++;
+			wattrset(dest, (*runs)[run].style);
 		}
 		// If it's a normal character, just draw it. If it's a tab, draw a
 		// bullet, then add spaces up til the next tab stop.
+		char ch = text[i];
 		if (ch != '\t') {
 			if (h >= hoff) waddch(dest, ch);
 			h++;
@@ -283,6 +358,14 @@ void Editor::View::update_dimensions(WINDOW *view) {
 
 void Editor::View::set_status(UI::Frame &ctx) {
 	std::string status = _doc.status();
+	// Editing a binary file is unlikely to end well, and neither is editing
+	// text in some encoding we didn't recognize; make sure the user knows
+	// that is what they are doing.
+	if (_doc.profile().binary) {
+		status = status.empty()? "Binary!": "Binary! " + status;
+	} else if (_doc.profile().invalid) {
+		status = status.empty()? "Not UTF-8!": "Not UTF-8! " + status;
+	}
 	if (!status.empty()) status.push_back(' ');
 	status.push_back('@');
 	// humans use weird 1-based line numbers
@@ -303,12 +386,11 @@ void Editor::View::ctl_copy(UI::Frame &ctx) {
 		auto endl = _doc.next_char(_doc.end(_cursor));
 		select(ctx, Range(begin, endl));
 	}
-	std::string clip = _doc.text(_selection);
-	ctx.app().set_clipboard(clip);
+	ctx.app().set_clipboard(_doc.text(_selection));
 }
 
 void Editor::View::ctl_paste(UI::Frame &ctx) {
-	std::string clip = ctx.app().get_clipboard();
+	Text clip = ctx.app().get_clipboard();
 	if (clip.empty()) return;
 	replace_selection(clip);
 }
@@ -316,7 +398,7 @@ void Editor::View::ctl_paste(UI::Frame &ctx) {
 void Editor::View::ctl_close(UI::Frame &ctx) {
 	if (!_doc.modified()) {
 		// no formality needed, we're done
-		ctx.app().close_file(_targetpath);
+		ctx.app().close_file(name());
 		return;
 	}
 	// ask the user if they want to save first
@@ -324,13 +406,15 @@ void Editor::View::ctl_close(UI::Frame &ctx) {
 	dialog.text = "You have modified this file. Save changes before closing?";
 	dialog.yes = [this](UI::Frame &ctx) {
 		// attempt to save, close if successful
-		if (save(ctx, _targetpath)) {
-			ctx.app().close_file(_targetpath);
+		if (_targetpath.empty()) {
+			ctl_save_as(ctx);
+		} else if (save(ctx, _targetpath) && finish_save(ctx)) {
+			ctx.app().close_file(name());
 		}
 	};
 	dialog.no = [this](UI::Frame &ctx) {
 		// just close it
-		ctx.app().close_file(_targetpath);
+		ctx.app().close_file(name());
 	};
 	dialog.show(ctx);
 }
@@ -357,9 +441,9 @@ void Editor::View::ctl_save_as(UI::Frame &ctx) {
 			return;
 		}
 		// Write the file to disk at its new location.
-		if (save(ctx, path)) {
+		if (save(ctx, path) && finish_save(ctx)) {
 			// Update the editor to point at the new path.
-			ctx.app().rename_file(_targetpath, path);
+			ctx.app().rename_file(name(), path);
 			_targetpath = path;
 			_config.load(_targetpath);
 			ctx.set_title(path);
@@ -457,6 +541,39 @@ void Editor::View::ctl_replace(UI::Frame &ctx) {
 	dialog.show(ctx);
 }
 
+void Editor::View::ctl_replace_all(UI::Frame &ctx) {
+	Dialog::Form::Field find;
+	find.name = "Find";
+	find.value = _find_text;
+	Dialog::Form::Field repl;
+	repl.name = "Replace";
+	repl.value = _replace_text;
+	Dialog::Form dialog;
+	dialog.fields = {find, repl};
+	dialog.commit = [this](UI::Frame& ctx, Dialog::Form::Result& res) {
+		_find_text = res.fields["Find"];
+		_replace_text = res.fields["Replace"];
+		if (_find_text.empty()) return;
+		if (_doc.read_only()) {
+			ctx.show_result("Document is read-only");
+			return;
+		}
+		size_t count = _doc.replace_all(_find_text, _replace_text);
+		if (count == 0) {
+			ctx.show_result("\"" + _find_text + "\" not found");
+			return;
+		}
+		// The cursor stays on its line, which may now be shorter.
+		_cursor.offset = std::min(_cursor.offset, _doc.end(_cursor).offset);
+		move_cursor(_cursor);
+		std::string message = "Replaced " + std::to_string(count);
+		message += (count == 1)? " occurrence": " occurrences";
+		ctx.show_result(message);
+	};
+	_find_next_action = FindNextAction::Nothing;
+	dialog.show(ctx);
+}
+
 void Editor::View::ctl_find_next(UI::Frame &ctx) {
 	if (_find_next_action == FindNextAction::Nothing) return;
 	if (_find_text.empty() || !find(ctx, _selection.end(), _find_text)) {
@@ -521,7 +638,7 @@ void Editor::View::delete_selection() {
 	move_cursor(_doc.erase(_selection));
 }
 
-Editor::Range Editor::View::replace_selection(std::string clip) {
+Editor::Range Editor::View::replace_selection(const Text &clip) {
 	delete_selection();
 	if (clip.empty()) {
 		return _selection;
@@ -549,23 +666,22 @@ void Editor::View::key_tab(UI::Frame &ctx) {
 			key_insert(_config.indent_style());
 		} while (0 != column(_cursor) % _config.indent_size());
 	} else {
-		line_frame_selection();
-		std::string text = _doc.text(_selection);
-		// Add an additional indent to the beginning of each selected line.
-		// Replace the selection with the new text. We do this as a single
-		// replacement operation so that it can be undone as a single action
-		// instead of a series of line-by-line adjustments.
+		// Add an additional indent to the beginning of each selected line
+		// which has anything on it. The lines change all at once, so the
+		// indent can be undone as a single action.
 		char indent_char = _config.indent_style();
 		size_t indent_count = ('\t' == indent_char)? 1: _config.indent_size();
-		size_t offset = 0;
-		while (offset != std::string::npos && offset < text.size()) {
-			text.insert(offset, indent_count, indent_char);
-			offset = text.find_first_of("\n\r", offset);
-			if (offset != std::string::npos) {
-				offset = text.find_first_not_of("\n\r", offset);
-			}
+		std::string indent(indent_count, indent_char);
+		std::vector<Document::Splice> edits;
+		line_frame_selection();
+		// A selection which ends at the beginning of a line does not
+		// include that line.
+		line_t stop = _selection.end().line + (_selection.end().offset? 1: 0);
+		for (line_t i = _selection.begin().line; i < stop; ++i) {
+			if (_doc.line(i).empty()) continue;
+			edits.push_back({i, 0, 0, indent});
 		}
-		_selection = replace_selection(text);
+		reframe_selection(edits);
 	}
 }
 
@@ -575,23 +691,20 @@ void Editor::View::key_btab(UI::Frame &ctx) {
 	// Remove the leftmost tab character or indent-sized sequence of spaces
 	// from each of the selected lines, then extend the selection to encompass
 	// all of those lines.
+	std::vector<Document::Splice> edits;
 	line_frame_selection();
-	std::string text = _doc.text(_selection);
-	size_t offset = 0;
-	while (offset != std::string::npos && offset < text.size()) {
-		size_t munch = offset;
-		while (text[munch] == ' ' && munch < text.size()) {
-			if (munch - offset >= _config.indent_size()) break;
+	line_t stop = _selection.end().line + (_selection.end().offset? 1: 0);
+	for (line_t i = _selection.begin().line; i < stop; ++i) {
+		const Line &text = _doc.line(i);
+		size_t munch = 0;
+		while (munch < text.size() && text[munch] == ' ') {
+			if (munch >= _config.indent_size()) break;
 			++munch;
 		}
-		if ('\t' == text[offset]) ++munch;
-		if (munch > offset) {
-			text.erase(offset, munch - offset);
-		}
-		offset = text.find_first_of("\n\r", offset);
-		offset = text.find_first_not_of("\n\r", offset);
+		if (!text.empty() && '\t' == text[0]) ++munch;
+		if (munch) edits.push_back({i, 0, munch, std::string()});
 	}
-	_selection = replace_selection(text);
+	reframe_selection(edits);
 }
 
 void Editor::View::key_escape(UI::Frame &ctx) {
@@ -612,7 +725,7 @@ void Editor::View::key_return(UI::Frame &ctx) {
 	line_t old_index = _cursor.line;
 	move_cursor(_doc.split(_cursor));
 	// Add whatever string of whitespace characters begins the previous line.
-	for (char ch: _doc.line(old_index)) {
+	for (char ch: _doc.line(old_index).str()) {
 		if (!isspace(ch)) break;
 		key_insert(ch);
 	}
@@ -646,6 +759,18 @@ void Editor::View::extend_selection(location_t loc) {
 	_selection.reset(_anchor, _cursor);
 }
 
+void Editor::View::reframe_selection(
+		const std::vector<Document::Splice> &edits) {
+	// Make the edits to the framed lines, then select all of them again,
+	// since their ends may have moved.
+	location_t begin = _selection.begin();
+	location_t end = _selection.end();
+	_doc.splice(edits);
+	if (end.offset) end = _doc.end(end);
+	move_cursor(end);
+	_selection.reset(begin, end);
+}
+
 void Editor::View::line_frame_selection() {
 	// If the beginning of the selection is not at the beginning of the line,
 	// move it back to home.
@@ -664,15 +789,7 @@ void Editor::View::line_frame_selection() {
 
 Editor::column_t Editor::View::column(location_t loc) {
 	// On which screen column does the character at this location appear?
-	column_t col = 0;
-	for (location_t i = _doc.home(loc); i < loc; i = _doc.next_char(i)) {
-		++col;
-		char32_t ch = _doc.codepoint(i);
-		if (ch == '\t') {
-			col += (_config.indent_size() - col % _config.indent_size());
-		}
-	}
-	return col;
+	return _columns.column(_doc, loc, _config.indent_size(), _update);
 }
 
 Editor::location_t Editor::View::arrow_up() {
@@ -736,19 +853,22 @@ Editor::location_t Editor::View::page_down() {
 	return _doc.home(_scroll.v + _height);
 }
 
+std::string Editor::View::name() const {
+	return _targetpath.empty()? _title: _targetpath;
+}
+
 bool Editor::View::save(UI::Frame &ctx, std::string dest) {
+	// Start writing the file in the background; poll() will report the
+	// result when it is done.
 	_doc.commit();
 	bool good = false;
 	try {
-		_doc.Write(dest);
-		std::string stat = "Wrote " + std::to_string(_doc.maxline()+1);
-		stat += (_doc.maxline() >= 1) ? " lines" : " line";
-		ctx.show_result(stat);
+		_doc.save(dest, _config);
 		good = true;
 	} catch (const std::runtime_error &e) {
 		ctx.show_result(e.what());
 	}
-	ctx.set_status(_doc.status());
+	set_status(ctx);
 	return good;
 }
 
@@ -19,27 +19,36 @@
 #define EDITOR_EDITOR_H
 
 #include "app/syntax.h"
+#include "editor/columns.h"
 #include "editor/config.h"
 #include "editor/document.h"
+#include "editor/styles.h"
 #include "editor/update.h"
 #include "ui/view.h"
 
 namespace Editor {
-class View : public UI::View {
+class View : public UI::View, private Observer {
 public:
 	View();
 	View(std::string targetpath);
+	// Show the text arriving from a stream, in a window with this title.
+	View(std::string title, std::unique_ptr<Stream> source);
 	virtual void activate(UI::Frame &ctx) override;
 	virtual void deactivate(UI::Frame &ctx) override;
 	virtual bool process(UI::Frame &ctx, int ch) override;
+	virtual bool poll(UI::Frame &ctx) override;
 	virtual void set_help(UI::HelpBar::Panel &panel) override;
 	void select(UI::Frame &ctx, Range range);
 	bool is_modified() const;
+	// Wait for any save in progress to finish, and report how it went.
+	bool finish_save(UI::Frame &ctx);
 protected:
 	virtual void paint_into(WINDOW *view, State state) override;
 	virtual void clear_overlay() override;
 private:
+	virtual void changed(const Delta &delta) override;
 	void postprocess(UI::Frame &ctx);
+	void refresh(UI::Frame &ctx);
 	void paint_line(WINDOW *view, row_t v, State state);
 	void reveal_cursor();
 	void update_dimensions(WINDOW *view);
@@ -55,6 +64,7 @@ private:
 	void ctl_toline(UI::Frame &ctx);
 	void ctl_find(UI::Frame &ctx);
 	void ctl_replace(UI::Frame &ctx);
+	void ctl_replace_all(UI::Frame &ctx);
 	void ctl_find_next(UI::Frame &ctx);
 	void ctl_undo(UI::Frame &ctx);
 	void ctl_redo(UI::Frame &ctx);
@@ -63,7 +73,7 @@ private:
 	// Data-entry keystrokes generally begin by deleting whatever was
 	// previously selected and possibly replacing it with something else.
 	void delete_selection();
-	Range replace_selection(std::string);
+	Range replace_selection(const Text&);
 	void key_insert(char ch);
 	void key_tab(UI::Frame &ctx);
 	void key_btab(UI::Frame &ctx);
@@ -79,6 +89,7 @@ private:
 	void extend_selection(location_t loc);
 	// Square the selection to the beginning and end of each line.
 	void line_frame_selection();
+	void reframe_selection(const std::vector<Document::Splice> &edits);
 	// On which screen column does this character location appear?
 	column_t column(location_t);
 	// Find some location relative to the cursor location.
@@ -89,11 +100,15 @@ private:
 	location_t page_up();
 	location_t page_down();
 
+	// What does the app call this editor? Until a document read from a
+	// stream has been saved, it goes by its title instead of a path.
+	std::string name() const;
 	bool save(UI::Frame &ctx, std::string dest);
 	bool find(UI::Frame &ctx, location_t anchor, std::string pattern);
 
 	// Information about the file being edited
 	std::string _targetpath;
+	std::string _title;
 	Document _doc;
 	// Syntax for this document's file type
 	const Syntax::Grammar &_syntax;
@@ -101,9 +116,14 @@ private:
 	// Information about the editor window
 	Config _config;
 	Update _update;
+	Columns _columns;
+	Styles _styles;
 	location_t _cursor;
 	location_t _anchor;
 	Range _selection;
+	// while the document catches up with its file, the cursor moves along
+	// with the lines around it
+	bool _tracking = false;
 	std::string _find_text;
 	std::string _replace_text;
 	enum class FindNextAction {
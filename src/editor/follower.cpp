@@ -0,0 +1,89 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/follower.h"
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+// Read appended text in pieces of this size.
+const size_t kReadSize = 64 * 1024;
+// Before reading more, make sure this much of the text we read last time is
+// still where we left it.
+const size_t kTailSize = 4 * 1024;
+} // namespace
+
+Editor::Follower::Follower(std::string path, const char *data, size_t size):
+		_offset(size) {
+	size_t tail = size;
+	while (tail > 0 && data[tail - 1] != '\x0A') --tail;
+	// There is no linebreak in what follows the last one, so the splitter
+	// will simply hold on to it.
+	std::vector<Line> none;
+	_splitter.feed(data + tail, size - tail, none);
+	remember(data, size);
+	_file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+}
+
+Editor::Follower::~Follower() {
+	if (_file >= 0) close(_file);
+}
+
+bool Editor::Follower::read(std::vector<Line> &lines, Hash &hash) {
+	if (_file < 0 || _truncated) return false;
+	struct stat sb;
+	if (fstat(_file, &sb)) return false;
+	size_t size = static_cast<size_t>(sb.st_size);
+	if (size < _offset) {
+		_truncated = true;
+		return false;
+	}
+	if (!_tail.empty()) {
+		std::string check(_tail.size(), '\0');
+		size_t pos = _offset - _tail.size();
+		ssize_t actual = pread(_file, &check[0], check.size(), pos);
+		if (actual != (ssize_t)check.size() || check != _tail) {
+			_truncated = true;
+			return false;
+		}
+	}
+	size_t count = lines.size();
+	std::string text;
+	while (_offset < size) {
+		text.resize(std::min(kReadSize, size - _offset));
+		ssize_t actual = pread(_file, &text[0], text.size(), _offset);
+		if (actual < 0 && errno == EINTR) continue;
+		if (actual <= 0) break;
+		_offset += actual;
+		hash.update(text.data(), actual);
+		remember(text.data(), actual);
+		_splitter.feed(text.data(), actual, lines);
+	}
+	return lines.size() > count;
+}
+
+void Editor::Follower::remember(const char *data, size_t size) {
+	if (size >= kTailSize) {
+		_tail.assign(data + size - kTailSize, kTailSize);
+		return;
+	}
+	_tail.append(data, size);
+	if (_tail.size() > kTailSize) _tail.erase(0, _tail.size() - kTailSize);
+}
@@ -0,0 +1,61 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#ifndef EDITOR_FOLLOWER_H
+#define EDITOR_FOLLOWER_H
+
+#include <string>
+#include <vector>
+#include "editor/hash.h"
+#include "editor/line.h"
+#include "editor/splitter.h"
+
+// A follower watches a file which something else is still writing, such as a
+// service's log, and picks up whatever gets appended to it. It reads only the
+// new bytes, starting where the last read left off, and hands them over one
+// whole line at a time. The document's watcher tells it when to look.
+namespace Editor {
+class Follower {
+public:
+	// Follow the file at this path, whose text so far we have already read.
+	// If it did not end with a linebreak, the partial line is the beginning
+	// of the next line we will report.
+	Follower(std::string path, const char *data, size_t size);
+	~Follower();
+	Follower(const Follower&) = delete;
+	Follower &operator=(const Follower&) = delete;
+	bool valid() const { return _file >= 0; }
+	bool partial() const { return _splitter.partial(); }
+	// Collect any whole lines which have been appended to the file since
+	// the last time we looked, adding the new bytes to the hash; return true
+	// if there were any.
+	bool read(std::vector<Line> &lines, Hash &hash);
+	// If the file shrank, or the last text we read from it is not there any
+	// more, it has been rewritten, and is no longer the file we were
+	// following.
+	bool truncated() const { return _truncated; }
+private:
+	void remember(const char *data, size_t size);
+	int _file = -1;
+	size_t _offset = 0;
+	std::string _tail;
+	bool _truncated = false;
+	Splitter _splitter;
+};
+} // namespace Editor
+
+#endif // EDITOR_FOLLOWER_H
@@ -0,0 +1,149 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/hash.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+const uint64_t kPrime1 = 11400714785074694791ULL;
+const uint64_t kPrime2 = 14029467366897019727ULL;
+const uint64_t kPrime3 = 1609587929392839161ULL;
+const uint64_t kPrime4 = 9650029242287828579ULL;
+const uint64_t kPrime5 = 2870177450012600261ULL;
+
+uint64_t rotl(uint64_t x, int r) {
+	return (x << r) | (x >> (64 - r));
+}
+
+uint64_t read64(const unsigned char *p) {
+	uint64_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+uint32_t read32(const unsigned char *p) {
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+uint64_t round(uint64_t acc, uint64_t input) {
+	acc += input * kPrime2;
+	acc = rotl(acc, 31);
+	return acc * kPrime1;
+}
+
+uint64_t merge(uint64_t h, uint64_t acc) {
+	h ^= round(0, acc);
+	return h * kPrime1 + kPrime4;
+}
+
+const unsigned char *stripes(
+		uint64_t acc[4], const unsigned char *p, const unsigned char *end) {
+	// Four independent lanes, eight bytes each, so the processor can keep
+	// all of them going at once.
+	while (p + 32 <= end) {
+		acc[0] = round(acc[0], read64(p));
+		acc[1] = round(acc[1], read64(p + 8));
+		acc[2] = round(acc[2], read64(p + 16));
+		acc[3] = round(acc[3], read64(p + 24));
+		p += 32;
+	}
+	return p;
+}
+
+uint64_t converge(const uint64_t acc[4]) {
+	uint64_t h = rotl(acc[0], 1) + rotl(acc[1], 7);
+	h += rotl(acc[2], 12) + rotl(acc[3], 18);
+	for (unsigned i = 0; i < 4; ++i) {
+		h = merge(h, acc[i]);
+	}
+	return h;
+}
+
+uint64_t finish(uint64_t h, const unsigned char *p, const unsigned char *end) {
+	// Fold in whatever is left over after the last whole stripe.
+	for (; p + 8 <= end; p += 8) {
+		h ^= round(0, read64(p));
+		h = rotl(h, 27) * kPrime1 + kPrime4;
+	}
+	if (p + 4 <= end) {
+		h ^= read32(p) * kPrime1;
+		h = rotl(h, 23) * kPrime2 + kPrime3;
+		p += 4;
+	}
+	for (; p < end; ++p) {
+		h ^= *p * kPrime5;
+		h = rotl(h, 11) * kPrime1;
+	}
+	// Stir the bits so every one of them depends on every input byte.
+	h ^= h >> 33;
+	h *= kPrime2;
+	h ^= h >> 29;
+	h *= kPrime3;
+	h ^= h >> 32;
+	return h;
+}
+} // namespace
+
+Editor::Hash::Hash(uint64_t seed): _seed(seed) {
+	_acc[0] = seed + kPrime1 + kPrime2;
+	_acc[1] = seed + kPrime2;
+	_acc[2] = seed;
+	_acc[3] = seed - kPrime1;
+}
+
+void Editor::Hash::update(const void *data, size_t size) {
+	auto p = static_cast<const unsigned char*>(data);
+	auto end = p + size;
+	_total += size;
+	// Top up a partial stripe left over from last time before going on.
+	if (_buffered) {
+		size_t fill = std::min(size, sizeof(_buffer) - _buffered);
+		memcpy(_buffer + _buffered, p, fill);
+		_buffered += fill;
+		p += fill;
+		if (_buffered < sizeof(_buffer)) return;
+		stripes(_acc, _buffer, _buffer + sizeof(_buffer));
+		_buffered = 0;
+	}
+	p = stripes(_acc, p, end);
+	memcpy(_buffer, p, end - p);
+	_buffered = end - p;
+}
+
+uint64_t Editor::Hash::digest() const {
+	uint64_t h = (_total >= 32)? converge(_acc): _seed + kPrime5;
+	h += _total;
+	return finish(h, _buffer, _buffer + _buffered);
+}
+
+uint64_t Editor::Hash::of(const void *data, size_t size) {
+	// The same as hashing in one update, but without copying the leftover
+	// bytes into a buffer; most lines are shorter than one stripe.
+	auto p = static_cast<const unsigned char*>(data);
+	auto end = p + size;
+	uint64_t h = kPrime5;
+	if (size >= 32) {
+		uint64_t acc[4] = {kPrime1 + kPrime2, kPrime2, 0, 0 - kPrime1};
+		p = stripes(acc, p, end);
+		h = converge(acc);
+	}
+	h += size;
+	return finish(h, p, end);
+}
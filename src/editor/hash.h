@@ -0,0 +1,46 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#ifndef EDITOR_HASH_H
+#define EDITOR_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+
+// A hash condenses a run of bytes into 64 bits, quickly enough to run over a
+// whole file without anyone noticing; this is the XXH64 algorithm. The bytes
+// may arrive in any number of pieces, and the digest comes out the same as if
+// they had all arrived at once, so we can keep a file's hash up to date as we
+// read more of it.
+namespace Editor {
+class Hash {
+public:
+	Hash(uint64_t seed = 0);
+	void update(const void *data, size_t size);
+	uint64_t digest() const;
+	// Hash a single run of bytes all at once.
+	static uint64_t of(const void *data, size_t size);
+private:
+	uint64_t _acc[4];
+	uint64_t _seed;
+	uint64_t _total = 0;
+	unsigned char _buffer[32];
+	size_t _buffered = 0;
+};
+} // namespace Editor
+
+#endif // EDITOR_HASH_H
@@ -0,0 +1,587 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/journal.h"
+#include "editor/compress.h"
+#include "editor/hash.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+// Each record begins with a header, then the erased text in one or more
+// chunks, then a trailer repeating the record's size, so we can find the
+// beginning of the record beneath it.
+struct Header {
+	uint64_t size;
+	uint64_t flags;
+	// where does the newest chunk of text begin, relative to the record?
+	uint64_t last;
+	uint64_t erase[4];
+	uint64_t insert[4];
+	uint64_t split[2];
+};
+// Text erased by backspacing is stored in front chunks, which are reversed.
+struct Chunk {
+	uint32_t size;
+	uint32_t front;
+};
+const uint32_t kErase = 1;
+const uint32_t kInsert = 2;
+const uint32_t kSplit = 4;
+const uint32_t kJoined = 8;
+const size_t kTrailer = sizeof(uint64_t);
+const size_t kChunkMax = UINT32_MAX;
+// A history file begins with this header, then carries the records from the
+// bottom of the journal up, laid out exactly as they would be in memory.
+struct History {
+	char magic[8];
+	// what were the contents of the file after the last of these changes,
+	// and what were the lines of the document they were written from?
+	uint64_t contents;
+	uint64_t lines;
+	uint64_t count;
+	uint64_t size;
+};
+const char kMagic[8] = {'o', 'z', 'u', 'n', 'd', 'o', '0', '2'};
+
+std::string s_spill_dir;
+size_t s_budget = 32 * 1024 * 1024;
+// Histories pile up for every file anyone ever saved, so the old ones go,
+// along with the least recently saved of the rest once there are too many.
+const time_t kHistoryAge = 30 * 24 * 60 * 60;
+const off_t kHistoryBudget = 256 * 1024 * 1024;
+
+std::string history_path(const std::string &file) {
+	// Each file's history goes under a name derived from its path.
+	if (s_spill_dir.empty() || file.empty()) return "";
+	char name[17];
+	uint64_t key = Editor::Hash::of(file.data(), file.size());
+	snprintf(name, sizeof(name), "%016llx", (unsigned long long)key);
+	return s_spill_dir + "/history/" + name;
+}
+
+void prune_history(const std::string &dir) {
+	DIR *listing = opendir(dir.c_str());
+	if (!listing) return;
+	struct entry {
+		std::string path;
+		time_t saved;
+		off_t size;
+	};
+	std::vector<entry> entries;
+	time_t cutoff = time(nullptr) - kHistoryAge;
+	while (struct dirent *item = readdir(listing)) {
+		if (item->d_name[0] == '.') continue;
+		std::string path = dir + "/" + item->d_name;
+		struct stat sb;
+		if (stat(path.c_str(), &sb) || !S_ISREG(sb.st_mode)) continue;
+		if (sb.st_mtime < cutoff) {
+			unlink(path.c_str());
+			continue;
+		}
+		entries.push_back({path, sb.st_mtime, sb.st_size});
+	}
+	closedir(listing);
+	std::sort(entries.begin(), entries.end(),
+			[](const entry &a, const entry &b) { return a.saved > b.saved; });
+	off_t total = 0;
+	for (auto &item: entries) {
+		total += item.size;
+		if (total > kHistoryBudget) unlink(item.path.c_str());
+	}
+}
+
+bool intact(const char *records, uint64_t size, uint64_t count) {
+	// A history file may have been cut short or scribbled on, so before we
+	// use its records, we follow their sizes down from the top, making sure
+	// each one leads to the next without leaving the file. Only headers and
+	// trailers are touched along the way, not the text between them.
+	uint64_t end = size;
+	uint64_t found = 0;
+	while (end > 0) {
+		uint64_t length;
+		if (end < kTrailer) return false;
+		memcpy(&length, records + end - kTrailer, kTrailer);
+		if (length < sizeof(Header) + kTrailer || length > end) return false;
+		const char *record = records + end - length;
+		Header header;
+		memcpy(&header, record, sizeof(header));
+		if (header.size != length) return false;
+		// The chunks of text must fill the record exactly, and the newest
+		// must be one of them.
+		uint64_t pos = sizeof(Header);
+		uint64_t stop = length - kTrailer;
+		bool last = header.last == 0;
+		while (pos < stop) {
+			if (stop - pos < sizeof(Chunk)) return false;
+			if (pos == header.last) last = true;
+			Chunk chunk;
+			memcpy(&chunk, record + pos, sizeof(chunk));
+			pos += sizeof(chunk);
+			if (chunk.size > stop - pos) return false;
+			pos += chunk.size;
+		}
+		if (!last) return false;
+		end -= length;
+		found++;
+	}
+	return found == count;
+}
+
+void put(uint64_t *out, const Editor::location_t &loc) {
+	out[0] = loc.line;
+	out[1] = loc.offset;
+}
+
+Editor::location_t get(const uint64_t *in) {
+	return Editor::location_t(in[0], in[1]);
+}
+
+void put(uint64_t *out, const Editor::Range &range) {
+	put(out, range.begin());
+	put(out + 2, range.end());
+}
+
+Editor::Range get_range(const uint64_t *in) {
+	return Editor::Range(get(in), get(in + 2));
+}
+} // namespace
+
+Editor::Journal::~Journal() {
+	if (_file >= 0) close(_file);
+	unmap_history();
+}
+
+void Editor::Journal::set_spill_dir(std::string path) {
+	s_spill_dir = path;
+	if (!path.empty()) prune_history(path + "/history");
+}
+
+void Editor::Journal::set_budget(size_t bytes) {
+	s_budget = bytes;
+}
+
+void Editor::Journal::clear() {
+	if (_count == 0 && !_map) return;
+	forget_spilled();
+	unmap_history();
+	std::string().swap(_data);
+	_top = 0;
+	_count = 0;
+	_resident = 0;
+}
+
+void Editor::Journal::push(const Change &change) {
+	Header header = {};
+	header.flags = (change.erase? kErase: 0) | (change.insert? kInsert: 0) |
+			(change.split? kSplit: 0) | (change.joined? kJoined: 0);
+	put(header.erase, change.eraseloc);
+	put(header.insert, change.insertloc);
+	put(header.split, change.splitloc);
+	header.size = sizeof(header) + kTrailer;
+	// Make room for the newest record by moving the oldest ones out.
+	if (_data.size() + header.size > s_budget) spill();
+	_top = _data.size();
+	_data.append(reinterpret_cast<const char*>(&header), sizeof(header));
+	_data.append(reinterpret_cast<const char*>(&header.size), kTrailer);
+	_count++;
+	_resident++;
+	if (!change.erasetext.empty()) {
+		append(change.erasetext.data(), change.erasetext.size(), false);
+	}
+}
+
+Editor::Change Editor::Journal::pop() {
+	load();
+	Change out;
+	if (_resident == 0) return out;
+	Header header;
+	memcpy(&header, &_data[_top], sizeof(header));
+	out = peek();
+	// The text is whatever went in front, newest first, followed by
+	// whatever went after, oldest first.
+	std::vector<std::pair<size_t, size_t>> front;
+	size_t pos = _top + sizeof(header);
+	size_t end = _top + header.size - kTrailer;
+	size_t total = 0;
+	while (pos < end) {
+		Chunk chunk;
+		memcpy(&chunk, &_data[pos], sizeof(chunk));
+		pos += sizeof(chunk);
+		if (chunk.front) front.emplace_back(pos, chunk.size);
+		total += chunk.size;
+		pos += chunk.size;
+	}
+	out.erasetext.reserve(total);
+	for (auto iter = front.rbegin(); iter != front.rend(); ++iter) {
+		out.erasetext.append(_data, iter->first, iter->second);
+		std::reverse(out.erasetext.end() - iter->second, out.erasetext.end());
+	}
+	pos = _top + sizeof(header);
+	while (pos < end) {
+		Chunk chunk;
+		memcpy(&chunk, &_data[pos], sizeof(chunk));
+		pos += sizeof(chunk);
+		if (!chunk.front) out.erasetext.append(_data, pos, chunk.size);
+		pos += chunk.size;
+	}
+	_data.resize(_top);
+	_count--;
+	_resident--;
+	if (_resident) {
+		uint64_t size;
+		memcpy(&size, &_data[_data.size() - kTrailer], kTrailer);
+		_top = _data.size() - size;
+	} else {
+		_top = 0;
+	}
+	return out;
+}
+
+Editor::Change Editor::Journal::peek() {
+	load();
+	Change out;
+	if (_resident == 0) return out;
+	Header header;
+	memcpy(&header, &_data[_top], sizeof(header));
+	out.erase = header.flags & kErase;
+	out.eraseloc = get_range(header.erase);
+	out.insert = header.flags & kInsert;
+	out.insertloc = get_range(header.insert);
+	out.split = header.flags & kSplit;
+	out.splitloc = get(header.split);
+	out.joined = header.flags & kJoined;
+	return out;
+}
+
+void Editor::Journal::amend(const Change &change) {
+	if (_resident == 0) return;
+	Header header;
+	memcpy(&header, &_data[_top], sizeof(header));
+	header.flags = (change.erase? kErase: 0) | (change.insert? kInsert: 0) |
+			(change.split? kSplit: 0) | (header.flags & kJoined);
+	put(header.erase, change.eraseloc);
+	put(header.insert, change.insertloc);
+	put(header.split, change.splitloc);
+	memcpy(&_data[_top], &header, sizeof(header));
+}
+
+void Editor::Journal::append(const Text &text, bool front) {
+	// Text going in front is added piece by piece from its end, since each
+	// piece goes in front of the one before.
+	size_t lines = text.lines();
+	for (size_t i = 0; i < lines; ++i) {
+		size_t index = front? lines - 1 - i: i;
+		if (front && i > 0) append("\n", 1, true);
+		Text::piece p = text.line(index);
+		append(p.data, p.size, front);
+		if (!front && i + 1 < lines) append("\n", 1, false);
+	}
+}
+
+void Editor::Journal::append(const char *data, size_t size, bool front) {
+	if (_resident == 0 || size == 0) return;
+	Header header;
+	memcpy(&header, &_data[_top], sizeof(header));
+	_data.resize(_data.size() - kTrailer);
+	while (size > 0) {
+		// Add to the newest chunk if it goes the same way, else begin anew.
+		Chunk chunk = {0, front};
+		if (header.last) memcpy(&chunk, &_data[_top + header.last], sizeof(chunk));
+		if (!header.last || chunk.front != front || chunk.size == kChunkMax) {
+			chunk = {0, front};
+			header.last = _data.size() - _top;
+			_data.append(reinterpret_cast<const char*>(&chunk), sizeof(chunk));
+		}
+		size_t count = std::min(size, kChunkMax - chunk.size);
+		if (front) {
+			// Reversed, the end of the text comes first.
+			size_t at = _data.size();
+			_data.append(data + size - count, count);
+			std::reverse(_data.begin() + at, _data.end());
+		} else {
+			_data.append(data, count);
+			data += count;
+		}
+		size -= count;
+		chunk.size += count;
+		memcpy(&_data[_top + header.last], &chunk, sizeof(chunk));
+	}
+	header.size = _data.size() + kTrailer - _top;
+	memcpy(&_data[_top], &header, sizeof(header));
+	_data.append(reinterpret_cast<const char*>(&header.size), kTrailer);
+}
+
+void Editor::Journal::load() {
+	// If the records in memory are all gone, bring back the newest of the
+	// ones we moved out, or failing that, the newest one in the history file.
+	if (_resident) return;
+	if (_spilled.empty()) {
+		if (_base_count == 0) return;
+		const char *records = static_cast<const char*>(_map) + sizeof(History);
+		uint64_t size = 0;
+		if (_base_size >= kTrailer) {
+			memcpy(&size, records + _base_size - kTrailer, kTrailer);
+		}
+		if (size < sizeof(Header) + kTrailer || size > _base_size) {
+			// The file has been damaged somehow, and the rest of its history
+			// is lost.
+			forget_older();
+			return;
+		}
+		_base_size -= size;
+		_base_count--;
+		_data.assign(records + _base_size, size);
+		_resident = 1;
+		_top = 0;
+		return;
+	}
+	Block block = _spilled.back();
+	_spilled.pop_back();
+	std::string packed(block.stored, '\0');
+	ssize_t actual = pread(_file, &packed[0], block.stored, block.offset);
+	if (actual != (ssize_t)block.stored ||
+			!decompress(packed.data(), packed.size(), block.size, _data)) {
+		// The history beyond this point is gone; there is nothing to do
+		// but forget about it.
+		_data.clear();
+		_count -= block.count;
+		forget_older();
+		return;
+	}
+	_end = block.offset;
+	_resident = block.count;
+	uint64_t size;
+	memcpy(&size, &_data[_data.size() - kTrailer], kTrailer);
+	_top = _data.size() - size;
+}
+
+void Editor::Journal::spill() {
+	// Move the oldest records, about half of what is in memory, out to the
+	// spill file; they are the least likely ever to be needed again.
+	if (_resident == 0) return;
+	size_t target = _data.size() / 2;
+	size_t cut = 0;
+	size_t count = 0;
+	while (count < _resident && (cut < target || count == 0)) {
+		uint64_t size;
+		memcpy(&size, &_data[cut], sizeof(size));
+		cut += size;
+		count++;
+	}
+	bool good = open_spill();
+	if (good) {
+		std::string packed = compress(_data.data(), cut);
+		ssize_t actual = pwrite(_file, packed.data(), packed.size(), _end);
+		good = actual == (ssize_t)packed.size();
+		if (good) {
+			_spilled.push_back(Block{_end, packed.size(), cut, count});
+			_end += packed.size();
+		}
+	}
+	if (!good) {
+		// With nowhere to put the oldest records, we must let them go, and
+		// everything older than them too.
+		_count -= count;
+		forget_older();
+	}
+	_data.erase(0, cut);
+	_resident -= count;
+	_top = _resident? _top - cut: 0;
+}
+
+bool Editor::Journal::open_spill() {
+	if (_file >= 0) return true;
+	if (s_spill_dir.empty()) return false;
+	mkdir(s_spill_dir.c_str(), S_IRWXU);
+	// Nobody else needs to see the file, and it should go away with us, so
+	// we unlink it as soon as it exists.
+	std::string path = s_spill_dir + "/undo-XXXXXX";
+	_file = mkstemp(&path[0]);
+	if (_file < 0) return false;
+	unlink(path.c_str());
+	fcntl(_file, F_SETFD, FD_CLOEXEC);
+	return true;
+}
+
+void Editor::Journal::forget_spilled() {
+	_spilled.clear();
+	_end = 0;
+	if (_file >= 0) {
+		close(_file);
+		_file = -1;
+	}
+}
+
+void Editor::Journal::forget_older() {
+	// Everything beneath the records in memory is out of reach.
+	for (auto &block: _spilled) {
+		_count -= block.count;
+	}
+	forget_spilled();
+	_count -= _base_count;
+	unmap_history();
+}
+
+bool Editor::Journal::restore(std::string file, uint64_t contents,
+		std::function<uint64_t()> lines) {
+	std::string path = history_path(file);
+	if (path.empty() || _count) return false;
+	int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) return false;
+	History header;
+	struct stat sb;
+	bool good = pread(fd, &header, sizeof(header), 0) == sizeof(header) &&
+			0 == fstat(fd, &sb) &&
+			0 == memcmp(header.magic, kMagic, sizeof(kMagic)) &&
+			header.contents == contents &&
+			header.size <= (uint64_t)sb.st_size - sizeof(header) &&
+			header.lines == lines();
+	if (!good) {
+		// The file has changed since this history was written, so its
+		// changes can no longer be undone.
+		close(fd);
+		unlink(path.c_str());
+		return false;
+	}
+	// Mapping the file costs little more than its number of records; the
+	// text in them will be paged in only if the user undoes that far.
+	size_t length = sizeof(header) + header.size;
+	void *addr = nullptr;
+	if (header.size) {
+		addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	close(fd);
+	if (addr == MAP_FAILED) return false;
+	auto base = static_cast<const char*>(addr);
+	if (!intact(base? base + sizeof(header): nullptr, header.size, header.count)) {
+		// The history is damaged, and there's no telling how much of it.
+		if (addr) munmap(addr, length);
+		unlink(path.c_str());
+		return false;
+	}
+	unmap_history();
+	_map = addr;
+	_map_size = length;
+	_base_size = header.size;
+	_base_count = header.size? header.count: 0;
+	_count = _base_count;
+	_history = path;
+	return _count > 0;
+}
+
+void Editor::Journal::preserve(
+		std::string file, uint64_t contents, uint64_t lines) {
+	std::string path = history_path(file);
+	if (path.empty()) return;
+	mkdir(s_spill_dir.c_str(), S_IRWXU);
+	mkdir((s_spill_dir + "/history").c_str(), S_IRWXU);
+	// Usually the history file we have mapped in is this very one, and it
+	// already holds every record beneath the ones we have added since the
+	// last save; we write only those, over any records undone out of the
+	// file, then bring the header up to date. The header goes last, so a
+	// history cut short along the way no longer matches the file and will be
+	// thrown away. Otherwise, like a saved document, the whole history goes
+	// into a temporary file, which then takes the old one's place at once.
+	bool append = _map && _history == path;
+	int fd = append? open(path.c_str(), O_RDWR | O_CLOEXEC): -1;
+	std::string temp = path + ".ozette-" + std::to_string(getpid());
+	if (fd < 0) {
+		append = false;
+		int flags = O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC;
+		fd = open(temp.c_str(), flags, S_IRUSR | S_IWUSR);
+	}
+	if (fd < 0) return;
+	History header = {};
+	memcpy(header.magic, kMagic, sizeof(kMagic));
+	uint64_t end = sizeof(header);
+	bool good = true;
+	auto put = [&](const char *data, size_t size) {
+		good = good && pwrite(fd, data, size, end) == (ssize_t)size;
+		end += size;
+	};
+	if (append) {
+		end += _base_size;
+	} else if (_base_size) {
+		put(static_cast<const char*>(_map) + sizeof(History), _base_size);
+	}
+	for (auto &block: _spilled) {
+		if (!good) break;
+		std::string packed(block.stored, '\0');
+		std::string records;
+		ssize_t actual = pread(_file, &packed[0], block.stored, block.offset);
+		good = actual == (ssize_t)block.stored && decompress(
+				packed.data(), packed.size(), block.size, records);
+		put(records.data(), records.size());
+	}
+	put(_data.data(), _data.size());
+	header.contents = contents;
+	header.lines = lines;
+	header.count = _count;
+	header.size = end - sizeof(header);
+	good = good && (!append || 0 == ftruncate(fd, end));
+	good = good && pwrite(fd, &header, sizeof(header), 0) == sizeof(header);
+	if (append && !good) {
+		// The file no longer holds a history worth keeping.
+		close(fd);
+		unlink(path.c_str());
+		_history.clear();
+		return;
+	}
+	if (!good || (!append && rename(temp.c_str(), path.c_str()))) {
+		close(fd);
+		unlink(temp.c_str());
+		return;
+	}
+	// The file now holds every record we have, so it can stand in for the
+	// ones in memory and in the spill file.
+	void *addr = nullptr;
+	if (header.size) {
+		addr = mmap(nullptr, end, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	close(fd);
+	if (addr == MAP_FAILED) {
+		_history.clear();
+		return;
+	}
+	unmap_history();
+	_map = addr;
+	_map_size = end;
+	_base_size = header.size;
+	_base_count = _count;
+	_history = path;
+	forget_spilled();
+	std::string().swap(_data);
+	_top = 0;
+	_resident = 0;
+}
+
+void Editor::Journal::unmap_history() {
+	if (_map) munmap(_map, _map_size);
+	_map = nullptr;
+	_map_size = 0;
+	_base_size = 0;
+	_base_count = 0;
+}
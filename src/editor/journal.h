@@ -0,0 +1,129 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#ifndef EDITOR_JOURNAL_H
+#define EDITOR_JOURNAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "editor/coordinates.h"
+#include "editor/text.h"
+
+namespace Editor {
+// One change to a document, as the undo history sees it: some text was
+// erased, then something may have been inserted in its place, and then a line
+// may have been split.
+struct Change {
+	bool erase = false;
+	Range eraseloc;
+	std::string erasetext;
+	bool insert = false;
+	Range insertloc;
+	bool split = false;
+	location_t splitloc;
+	// Does this change belong to the same edit as the change before it, so
+	// that they must be undone together?
+	bool joined = false;
+};
+
+// A journal is a stack of changes, packed end to end into one buffer as
+// records with the erased text inline, so the history of a long editing
+// session costs little more than the text it removed. The newest record can
+// keep growing as the user keeps typing or deleting in the same place; text
+// erased by backspacing goes into it backwards, so it can be added at the
+// end of the buffer like everything else. Past a certain size, the oldest
+// records are compressed and moved out to a scratch file in the cache
+// directory, to be read back in if the user ever undoes that far.
+// When the document is saved, the journal can be saved alongside it as a
+// history file, which holds the same records, uncompressed, beneath a header
+// naming the file contents they lead up to. The next time the file is opened,
+// the history file is mapped back in as the bottom of the journal, and
+// records are copied out of it only as the user undoes into them.
+class Journal {
+public:
+	Journal() {}
+	~Journal();
+	Journal(const Journal&) = delete;
+	Journal &operator=(const Journal&) = delete;
+	// Where should journals put the records they move out of memory, and how
+	// much memory may each one use before it does? Without a directory, the
+	// oldest records are simply forgotten.
+	static void set_spill_dir(std::string path);
+	static void set_budget(size_t bytes);
+	bool empty() const { return _count == 0; }
+	size_t count() const { return _count; }
+	void clear();
+	void push(const Change &change);
+	Change pop();
+	// Look at the newest change, minus its text, or update its locations
+	// after combining another change with it.
+	Change peek();
+	void amend(const Change &change);
+	// Add more erased text to the newest change, after the text it already
+	// has, or in front of it.
+	void append(const Text &text, bool front);
+	void append(const char *data, size_t size, bool front);
+	// How many bytes of records are in memory?
+	size_t resident() const { return _data.size(); }
+	// Pick up the history saved with this file, if the file still has the
+	// contents it had then, and they still read in as the same lines; a
+	// history which no longer matches is deleted. The lines are only hashed
+	// if there is a history to check them against. The journal must be empty
+	// to begin with.
+	bool restore(std::string file, uint64_t contents,
+			std::function<uint64_t()> lines);
+	// Save the history of this file, given digests of its contents and of
+	// the document lines they were written from. Only the records added
+	// since the history was last saved or restored are written, at the end
+	// of its file; a new history is written out whole, to a new file which
+	// replaces the old one. Afterward, the records all live in the file.
+	// Histories not saved in a month are deleted when the spill directory is
+	// set, as are the oldest once they take up too much room.
+	void preserve(std::string file, uint64_t contents, uint64_t lines);
+private:
+	void load();
+	void spill();
+	bool open_spill();
+	void forget_spilled();
+	void forget_older();
+	void unmap_history();
+	std::string _data;
+	size_t _top = 0;
+	size_t _count = 0;
+	size_t _resident = 0;
+	struct Block {
+		uint64_t offset;
+		size_t stored;
+		size_t size;
+		size_t count;
+	};
+	std::vector<Block> _spilled;
+	int _file = -1;
+	uint64_t _end = 0;
+	// The oldest records may be in a history file instead, mapped in.
+	std::string _history;
+	void *_map = nullptr;
+	size_t _map_size = 0;
+	size_t _base_size = 0;
+	size_t _base_count = 0;
+};
+} // namespace Editor
+
+#endif // EDITOR_JOURNAL_H
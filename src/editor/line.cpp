@@ -0,0 +1,150 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/line.h"
+#include <algorithm>
+#include <cstring>
+
+static_assert(sizeof(Editor::Line) == 32, "lines should stay compact");
+
+Editor::Line::Line():
+		_size(0),
+		_class(static_cast<size_t>(TextClass::ASCII)),
+		_storage(static_cast<size_t>(Storage::Inline)) {
+}
+
+Editor::Line::Line(std::string text):
+		_size(text.size()),
+		_class(static_cast<size_t>(classify(text.data(), text.size()))) {
+	if (text.size() <= kInlineMax) {
+		_storage = static_cast<size_t>(Storage::Inline);
+		memcpy(_in, text.data(), text.size());
+		return;
+	}
+	_storage = static_cast<size_t>(Storage::Heap);
+	auto owner = std::make_shared<const std::string>(std::move(text));
+	new (&_out) outside{owner->data(), owner};
+}
+
+Editor::Line::Line(const char *data, size_t size):
+		_size(size),
+		_class(static_cast<size_t>(classify(data, size))),
+		_storage(static_cast<size_t>(Storage::Borrowed)) {
+	new (&_out) outside{data, nullptr};
+}
+
+Editor::Line::Line(const char *data, size_t size, Arena &arena):
+		_size(size),
+		_class(static_cast<size_t>(classify(data, size))) {
+	if (size <= kInlineMax) {
+		_storage = static_cast<size_t>(Storage::Inline);
+		memcpy(_in, data, size);
+		return;
+	}
+	_storage = static_cast<size_t>(Storage::Arena);
+	new (&_out) outside{nullptr, nullptr};
+	_out.data = arena.store(data, size, _out.owner);
+}
+
+Editor::Line::Line(const Line &other) {
+	assign(other);
+}
+
+Editor::Line::Line(Line &&other) noexcept {
+	take(other);
+}
+
+Editor::Line &Editor::Line::operator=(const Line &other) {
+	if (this != &other) {
+		release();
+		assign(other);
+	}
+	return *this;
+}
+
+Editor::Line &Editor::Line::operator=(Line &&other) noexcept {
+	if (this != &other) {
+		release();
+		take(other);
+	}
+	return *this;
+}
+
+Editor::Line::~Line() {
+	release();
+}
+
+size_t Editor::Line::find(const std::string &needle, size_t pos) const {
+	if (pos > _size) return std::string::npos;
+	const char *begin = data();
+	const char *end = begin + _size;
+	const char *match = std::search(
+			begin + pos, end, needle.begin(), needle.end());
+	if (match == end && !needle.empty()) return std::string::npos;
+	return match - begin;
+}
+
+size_t Editor::Line::capacity() const {
+	switch (storage()) {
+		case Storage::Heap: {
+			// The string, its header, and the shared control block around it.
+			auto text = static_cast<const std::string*>(_out.owner.get());
+			return text->capacity() + 1 + sizeof(std::string) + 16;
+		}
+		case Storage::Arena: return Arena::capacity(_out.owner);
+		default: return 0;
+	}
+}
+
+bool Editor::Line::same(const Line &other) const {
+	if (_size != other._size || _storage != other._storage) return false;
+	if (inline_text()) return 0 == memcmp(_in, other._in, _size);
+	return _out.data == other._out.data;
+}
+
+void Editor::Line::assign(const Line &other) {
+	_size = other._size;
+	_class = other._class;
+	_storage = other._storage;
+	if (inline_text()) {
+		memcpy(_in, other._in, kInlineMax);
+	} else {
+		new (&_out) outside(other._out);
+	}
+}
+
+void Editor::Line::take(Line &other) noexcept {
+	// Move the other line's text into this one, leaving the other empty.
+	_size = other._size;
+	_class = other._class;
+	_storage = other._storage;
+	if (inline_text()) {
+		memcpy(_in, other._in, kInlineMax);
+	} else {
+		new (&_out) outside(std::move(other._out));
+		other.release();
+	}
+	other._size = 0;
+	other._class = static_cast<size_t>(TextClass::ASCII);
+}
+
+void Editor::Line::release() noexcept {
+	if (!inline_text()) {
+		_out.~outside();
+		_storage = static_cast<size_t>(Storage::Inline);
+	}
+}
@@ -0,0 +1,93 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#ifndef EDITOR_LINE_H
+#define EDITOR_LINE_H
+
+#include <memory>
+#include <string>
+#include "editor/arena.h"
+#include "editor/utf8.h"
+
+// A line is a run of text which never changes once created; editing a line
+// means replacing it with a new one. Copies of a line share its text, so that
+// any number of document versions can refer to the same lines at little cost.
+// Where the text lives depends on where it came from: a short line keeps its
+// text inside the line object itself, a line loaded from a file borrows its
+// slice of the mapping, a line created in bulk shares an arena chunk with its
+// neighbors, and anything else gets a string of its own.
+namespace Editor {
+class Line {
+public:
+	enum class Storage {
+		Inline,
+		Borrowed,
+		Heap,
+		Arena
+	};
+	Line();
+	Line(std::string text);
+	Line(const char *data, size_t size);
+	Line(const char *data, size_t size, Arena &arena);
+	Line(const Line &other);
+	Line(Line &&other) noexcept;
+	Line &operator=(const Line &other);
+	Line &operator=(Line &&other) noexcept;
+	~Line();
+	size_t size() const { return _size; }
+	bool empty() const { return 0 == _size; }
+	const char *data() const { return inline_text()? _in: _out.data; }
+	// Is every character a single byte? Is the text valid UTF-8 at all?
+	TextClass text_class() const { return static_cast<TextClass>(_class); }
+	bool ascii() const { return text_class() == TextClass::ASCII; }
+	// Reading past the end yields NUL, as it would for a std::string, so
+	// that decoders scanning for continuation bytes stop at the edge.
+	char operator[](size_t i) const { return i < _size? data()[i]: '\0'; }
+	std::string str() const { return std::string(data(), _size); }
+	size_t find(const std::string &needle, size_t pos) const;
+	// Where does the text live, and what else is it sharing that space with?
+	// A borrowed line depends on its mapping, which must outlive it; the other
+	// kinds of line keep their own text alive.
+	Storage storage() const { return static_cast<Storage>(_storage); }
+	bool owned() const { return storage() != Storage::Borrowed; }
+	const void *owner() const { return inline_text()? nullptr: _out.owner.get(); }
+	// How many bytes has the owner set aside, counting its own overhead?
+	size_t capacity() const;
+	// Is this the very same text as the other line? Lines which share their
+	// storage need not compare every byte to find out.
+	bool same(const Line &other) const;
+private:
+	static const size_t kInlineMax = 24;
+	bool inline_text() const { return storage() == Storage::Inline; }
+	void assign(const Line &other);
+	void take(Line &other) noexcept;
+	void release() noexcept;
+	struct outside {
+		const char *data;
+		std::shared_ptr<const void> owner;
+	};
+	union {
+		outside _out;
+		char _in[kInlineMax];
+	};
+	size_t _size: 60;
+	size_t _class: 2;
+	size_t _storage: 2;
+};
+} // namespace Editor
+
+#endif // EDITOR_LINE_H
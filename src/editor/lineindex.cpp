@@ -0,0 +1,137 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/lineindex.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+// The density of linebreaks in this much of the buffer predicts the rest.
+const size_t kSample = 16 * 1024;
+
+template <typename T>
+void scan_scalar(const char *data, size_t pos, size_t size, std::vector<T> &out) {
+	// The C library's memchr is already well tuned; what it can't do is find
+	// more than one match per call, which costs us on files of short lines.
+	while (pos < size) {
+		const void *match = memchr(data + pos, '\n', size - pos);
+		if (!match) break;
+		pos = static_cast<const char*>(match) - data;
+		out.push_back(static_cast<T>(pos++));
+	}
+}
+
+#if defined(__SSE2__)
+template <typename T>
+size_t scan_sse2(const char *data, size_t size, std::vector<T> &out, bool &nul) {
+	// Compare sixteen bytes at a time against the linebreak, then turn the
+	// result into a bitmask and peel off the position of each set bit. The
+	// comparisons against zero accumulate, to be checked once at the end.
+	const __m128i nl = _mm_set1_epi8('\n');
+	const __m128i zero = _mm_setzero_si128();
+	__m128i zeros = zero;
+	size_t pos = 0;
+	for (; pos + 16 <= size; pos += 16) {
+		__m128i chunk = _mm_loadu_si128((const __m128i*)(data + pos));
+		zeros = _mm_or_si128(zeros, _mm_cmpeq_epi8(chunk, zero));
+		unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, nl));
+		while (mask) {
+			out.push_back(static_cast<T>(pos + __builtin_ctz(mask)));
+			mask &= mask - 1;
+		}
+	}
+	nul = 0 != _mm_movemask_epi8(zeros);
+	return pos;
+}
+
+template <typename T>
+__attribute__((target("avx2")))
+size_t scan_avx2(const char *data, size_t size, std::vector<T> &out, bool &nul) {
+	// The same approach, sixty-four bytes per iteration.
+	const __m256i nl = _mm256_set1_epi8('\n');
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i zeros = zero;
+	size_t pos = 0;
+	for (; pos + 64 <= size; pos += 64) {
+		__m256i lo = _mm256_loadu_si256((const __m256i*)(data + pos));
+		__m256i hi = _mm256_loadu_si256((const __m256i*)(data + pos + 32));
+		zeros = _mm256_or_si256(zeros, _mm256_cmpeq_epi8(lo, zero));
+		zeros = _mm256_or_si256(zeros, _mm256_cmpeq_epi8(hi, zero));
+		uint64_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, nl));
+		mask |= (uint64_t)(uint32_t)_mm256_movemask_epi8(
+				_mm256_cmpeq_epi8(hi, nl)) << 32;
+		while (mask) {
+			out.push_back(static_cast<T>(pos + __builtin_ctzll(mask)));
+			mask &= mask - 1;
+		}
+	}
+	nul = 0 != _mm256_movemask_epi8(zeros);
+	return pos;
+}
+#endif
+
+template <typename T>
+bool find_breaks(const char *data, size_t size, std::vector<T> &out) {
+	// Count the breaks near the top and reserve room for the whole buffer at
+	// the same density, plus a little to spare, so the table will rarely
+	// have to grow. We won't trim it afterward, either: that would copy the
+	// whole table just to give back the slack.
+	size_t sample = std::min(size, kSample);
+	if (sample) {
+		size_t count = std::count(data, data + sample, '\n');
+		size_t expect = size / sample * count + count;
+		out.reserve(expect + expect / 8);
+	}
+	size_t pos = 0;
+	bool nul = false;
+#if defined(__SSE2__)
+	static const bool avx2 = __builtin_cpu_supports("avx2");
+	pos = avx2? scan_avx2(data, size, out, nul): scan_sse2(data, size, out, nul);
+#endif
+	scan_scalar(data, pos, size, out);
+	return nul || memchr(data + pos, '\0', size - pos);
+}
+} // namespace
+
+void Editor::LineIndex::scan(const char *data, size_t size) {
+	_bytes = size;
+	_short.clear();
+	_long.clear();
+	if (size <= std::numeric_limits<uint32_t>::max()) {
+		_nul = find_breaks(data, size, _short);
+	} else {
+		_nul = find_breaks(data, size, _long);
+	}
+}
+
+size_t Editor::LineIndex::size() const {
+	size_t count = breaks();
+	if (0 == count) return _bytes? 1: 0;
+	return count + (brk(count - 1) + 1 < _bytes? 1: 0);
+}
+
+size_t Editor::LineIndex::begin(size_t index) const {
+	return index? brk(index - 1) + 1: 0;
+}
+
+size_t Editor::LineIndex::end(size_t index) const {
+	return index < breaks()? brk(index): _bytes;
+}
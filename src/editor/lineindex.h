@@ -0,0 +1,53 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#ifndef EDITOR_LINEINDEX_H
+#define EDITOR_LINEINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A line index records the offset of every linebreak in a buffer, so that any
+// line can be located again without rescanning the text. The scan examines a
+// whole vector register's worth of bytes at a time where the processor allows
+// it. Offsets are stored in 32 bits whenever the buffer is small enough, which
+// halves the size of the table for all but the most enormous files. While it
+// is looking at every byte, the scan also notices any NULs, which are a sign
+// that the buffer holds something other than text.
+namespace Editor {
+class LineIndex {
+public:
+	void scan(const char *data, size_t size);
+	// How many lines are there? A final line with no linebreak still counts,
+	// but an empty buffer, or the nothing after a final linebreak, does not.
+	size_t size() const;
+	// Where does the indexed line begin, and where is its linebreak?
+	size_t begin(size_t index) const;
+	size_t end(size_t index) const;
+	bool nul() const { return _nul; }
+private:
+	size_t breaks() const { return _short.size() + _long.size(); }
+	size_t brk(size_t i) const { return _long.empty()? _short[i]: _long[i]; }
+	size_t _bytes = 0;
+	bool _nul = false;
+	std::vector<uint32_t> _short;
+	std::vector<uint64_t> _long;
+};
+} // namespace Editor
+
+#endif // EDITOR_LINEINDEX_H
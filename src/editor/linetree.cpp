@@ -0,0 +1,359 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/linetree.h"
+#include "editor/hash.h"
+#include <assert.h>
+
+namespace {
+// Leaves hold a modest number of lines, so that an edit shuffles no more than
+// a page or two of string headers; branches hold enough children to keep the
+// tree shallow even for a file with many millions of lines.
+const size_t kLeafMax = 128;
+const size_t kBranchMax = 32;
+// The hash of a run of lines is a polynomial in this odd constant, with one
+// term per line, so that two runs can be combined without revisiting them.
+const uint64_t kBase = 0x9E3779B97F4A7C15ULL;
+} // namespace
+
+Editor::LineTree::LineTree():
+		_root(new Node) {
+}
+
+const Editor::Line &Editor::LineTree::operator[](size_t index) const {
+	const Node &leaf = find(index);
+	return leaf.lines[index];
+}
+
+void Editor::LineTree::set(size_t index, Line text) {
+	Node &leaf = find_mutable(index);
+	leaf.lines[index] = std::move(text);
+}
+
+void Editor::LineTree::insert(size_t index, Line text) {
+	assert(index <= size());
+	NodePtr sibling = insert(own(_root), index, std::move(text));
+	if (sibling) {
+		// The root has split, so the tree must grow one level taller.
+		NodePtr root(new Node);
+		root->count = _root->count + sibling->count;
+		root->children.push_back(std::move(_root));
+		root->children.push_back(std::move(sibling));
+		_root = std::move(root);
+	}
+}
+
+void Editor::LineTree::insert(size_t index, std::vector<Line> lines) {
+	assert(index <= size());
+	if (lines.empty()) return;
+	auto siblings = splice(own(_root), index, lines.begin(), lines.end());
+	while (!siblings.empty()) {
+		// The root has split, perhaps many ways, so the tree must grow taller;
+		// if the new root has too many children, it must split in turn.
+		NodePtr root(new Node);
+		root->count = _root->count;
+		root->children.push_back(std::move(_root));
+		for (auto &sibling: siblings) {
+			root->count += sibling->count;
+			root->children.push_back(std::move(sibling));
+		}
+		_root = std::move(root);
+		siblings = divide(*_root);
+	}
+}
+
+void Editor::LineTree::erase(size_t begin, size_t end) {
+	end = std::min(end, size());
+	if (begin >= end) return;
+	erase(own(_root), begin, end - begin);
+	collapse();
+}
+
+void Editor::LineTree::clear() {
+	_root.reset(new Node);
+}
+
+uint64_t Editor::LineTree::digest() const {
+	rehash(*_root);
+	return _root->hash * kBase + _root->count;
+}
+
+Editor::LineTree::const_iterator &Editor::LineTree::const_iterator::operator++() {
+	++_index;
+	if (++_offset < _chunk->size()) return *this;
+	// We have reached the end of this leaf, so look up the next one.
+	*this = const_iterator(*_tree, _index);
+	return *this;
+}
+
+bool Editor::LineTree::const_iterator::operator==(
+		const const_iterator &other) const {
+	return _tree == other._tree && _index == other._index;
+}
+
+Editor::LineTree::const_iterator::const_iterator(
+		const LineTree &tree, size_t index):
+		_tree(&tree),
+		_index(index) {
+	if (index < tree.size()) {
+		const Node &leaf = tree.find(index);
+		_chunk = &leaf.lines;
+		_offset = index;
+	}
+}
+
+const Editor::LineTree::Node &Editor::LineTree::find(size_t &index) const {
+	// Descend toward the leaf containing the indexed line, converting the
+	// index into an offset relative to each subtree as we go.
+	assert(index < size());
+	const Node *node = _root.get();
+	while (!node->leaf()) {
+		auto iter = node->children.begin();
+		while (index >= (*iter)->count) {
+			index -= (*iter)->count;
+			++iter;
+		}
+		node = iter->get();
+	}
+	return *node;
+}
+
+Editor::LineTree::Node &Editor::LineTree::find_mutable(size_t &index) {
+	// Descend as find() does, but take ownership of each node along the way,
+	// since the caller is about to change the leaf.
+	assert(index < size());
+	Node *node = &own(_root);
+	while (!node->leaf()) {
+		auto iter = node->children.begin();
+		while (index >= (*iter)->count) {
+			index -= (*iter)->count;
+			++iter;
+		}
+		node = &own(*iter);
+	}
+	return *node;
+}
+
+Editor::LineTree::Node &Editor::LineTree::own(NodePtr &node) {
+	// If some other tree shares this node, we must not change it out from
+	// under them; make a copy of our own instead. The copy shares its
+	// children, and its lines share their strings, so this is cheap.
+	if (node.use_count() > 1) {
+		node = std::make_shared<Node>(*node);
+	}
+	// Whatever the caller is about to do will change the node's hash.
+	node->hashed = false;
+	return *node;
+}
+
+Editor::LineTree::NodePtr Editor::LineTree::insert(
+		Node &node, size_t index, Line &&text) {
+	// Insert the line into this subtree. If that overfills the node, split it
+	// in half and return the new upper half, which the caller must insert as
+	// the next sibling of this node.
+	node.count++;
+	NodePtr sibling;
+	if (node.leaf()) {
+		node.lines.emplace(node.lines.begin() + index, std::move(text));
+		if (node.lines.size() <= kLeafMax) return sibling;
+		sibling.reset(new Node);
+		auto half = node.lines.begin() + node.lines.size() / 2;
+		sibling->lines.assign(
+				std::make_move_iterator(half),
+				std::make_move_iterator(node.lines.end()));
+		node.lines.erase(half, node.lines.end());
+		sibling->count = sibling->lines.size();
+	} else {
+		size_t i = 0;
+		while (i + 1 < node.children.size() && index > node.children[i]->count) {
+			index -= node.children[i++]->count;
+		}
+		NodePtr split = insert(own(node.children[i]), index, std::move(text));
+		if (!split) return sibling;
+		node.children.emplace(node.children.begin() + i + 1, std::move(split));
+		if (node.children.size() <= kBranchMax) return sibling;
+		sibling.reset(new Node);
+		auto half = node.children.begin() + node.children.size() / 2;
+		sibling->children.assign(
+				std::make_move_iterator(half),
+				std::make_move_iterator(node.children.end()));
+		node.children.erase(half, node.children.end());
+		for (auto &child: sibling->children) {
+			sibling->count += child->count;
+		}
+	}
+	node.count -= sibling->count;
+	return sibling;
+}
+
+std::vector<Editor::LineTree::NodePtr> Editor::LineTree::splice(
+		Node &node, size_t index, LineIter begin, LineIter end) {
+	// Insert the lines into this subtree, as insert() does for a single line,
+	// but the node may overflow by any amount, so it may have to split into
+	// many pieces; we return all of the new siblings, in order.
+	node.count += end - begin;
+	if (node.leaf()) {
+		node.lines.insert(node.lines.begin() + index,
+				std::make_move_iterator(begin),
+				std::make_move_iterator(end));
+		return divide(node);
+	}
+	size_t i = 0;
+	while (i + 1 < node.children.size() && index > node.children[i]->count) {
+		index -= node.children[i++]->count;
+	}
+	auto split = splice(own(node.children[i]), index, begin, end);
+	if (split.empty()) return split;
+	node.children.insert(node.children.begin() + i + 1,
+			std::make_move_iterator(split.begin()),
+			std::make_move_iterator(split.end()));
+	return divide(node);
+}
+
+std::vector<Editor::LineTree::NodePtr> Editor::LineTree::divide(Node &node) {
+	// If this node has overflowed, cut it into as few pieces as will fit,
+	// all of roughly equal size. The node keeps the first piece; the rest go
+	// into new nodes, which we return.
+	std::vector<NodePtr> out;
+	size_t items = node.leaf()? node.lines.size(): node.children.size();
+	size_t limit = node.leaf()? kLeafMax: kBranchMax;
+	if (items <= limit) return out;
+	size_t pieces = (items + limit - 1) / limit;
+	for (size_t piece = 1; piece < pieces; ++piece) {
+		size_t begin = piece * items / pieces;
+		size_t end = (piece + 1) * items / pieces;
+		NodePtr sibling(new Node);
+		if (node.leaf()) {
+			sibling->lines.assign(
+					std::make_move_iterator(node.lines.begin() + begin),
+					std::make_move_iterator(node.lines.begin() + end));
+			sibling->count = sibling->lines.size();
+		} else {
+			sibling->children.assign(
+					std::make_move_iterator(node.children.begin() + begin),
+					std::make_move_iterator(node.children.begin() + end));
+			for (auto &child: sibling->children) {
+				sibling->count += child->count;
+			}
+		}
+		node.count -= sibling->count;
+		out.push_back(std::move(sibling));
+	}
+	size_t keep = items / pieces;
+	if (node.leaf()) {
+		node.lines.resize(keep);
+	} else {
+		node.children.resize(keep);
+	}
+	return out;
+}
+
+void Editor::LineTree::erase(Node &node, size_t index, size_t count) {
+	// Remove count lines beginning at index from this subtree. Children which
+	// lie entirely inside the range can simply be dropped; only the children
+	// at either edge of the range need a recursive visit.
+	node.count -= count;
+	if (node.leaf()) {
+		auto begin = node.lines.begin() + index;
+		node.lines.erase(begin, begin + count);
+		return;
+	}
+	size_t i = 0;
+	while (count > 0 && i < node.children.size()) {
+		const Node &child = *node.children[i];
+		if (index >= child.count) {
+			index -= child.count;
+			++i;
+			continue;
+		}
+		size_t chunk = std::min(count, child.count - index);
+		if (chunk < child.count) {
+			erase(own(node.children[i]), index, chunk);
+			++i;
+		} else {
+			node.children.erase(node.children.begin() + i);
+		}
+		count -= chunk;
+		index = 0;
+	}
+	rebalance(node);
+}
+
+void Editor::LineTree::rebalance(Node &node) {
+	// Merge neighboring children which have become sparse, so that a long
+	// series of deletions cannot leave behind a tree full of tiny nodes. We
+	// leave some slack below the maximum so that a node which has just been
+	// split will not immediately be merged back together again.
+	size_t i = 0;
+	while (i + 1 < node.children.size()) {
+		const Node &left = *node.children[i];
+		const Node &right = *node.children[i + 1];
+		bool sparse = left.leaf()?
+				left.lines.size() + right.lines.size() <= kLeafMax * 3 / 4:
+				left.children.size() + right.children.size() <= kBranchMax * 3 / 4;
+		if (!sparse) {
+			++i;
+			continue;
+		}
+		Node &a = own(node.children[i]);
+		Node &b = own(node.children[i + 1]);
+		if (a.leaf()) {
+			a.lines.insert(a.lines.end(),
+					std::make_move_iterator(b.lines.begin()),
+					std::make_move_iterator(b.lines.end()));
+		} else {
+			a.children.insert(a.children.end(),
+					std::make_move_iterator(b.children.begin()),
+					std::make_move_iterator(b.children.end()));
+		}
+		a.count += b.count;
+		node.children.erase(node.children.begin() + i + 1);
+	}
+}
+
+void Editor::LineTree::rehash(const Node &node) {
+	if (node.hashed) return;
+	uint64_t hash = 0;
+	uint64_t power = 1;
+	if (node.leaf()) {
+		for (auto &line: node.lines) {
+			hash = hash * kBase + Hash::of(line.data(), line.size());
+			power *= kBase;
+		}
+	} else {
+		for (auto &child: node.children) {
+			rehash(*child);
+			hash = hash * child->power + child->hash;
+			power *= child->power;
+		}
+	}
+	node.hash = hash;
+	node.power = power;
+	node.hashed = true;
+}
+
+void Editor::LineTree::collapse() {
+	// If the root has been reduced to a single child, that child can become
+	// the new root, and the tree becomes one level shorter.
+	while (!_root->leaf() && _root->children.size() == 1) {
+		NodePtr child = _root->children.front();
+		_root = child;
+	}
+	if (0 == _root->count) {
+		clear();
+	}
+}
@@ -0,0 +1,113 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#ifndef EDITOR_LINETREE_H
+#define EDITOR_LINETREE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "editor/line.h"
+
+// A line tree is the backing store for a document. It keeps the lines in
+// small chunks at the leaves of a balanced tree, where each branch knows how
+// many lines lie beneath it, so that finding, inserting, or removing a line
+// costs time proportional to the log of the document's length rather than
+// shuffling every line which follows it.
+// Copying a line tree is cheap: the copies share their nodes, and an edit to
+// either copy duplicates only the nodes along the path to the edited leaf.
+// This gives background workers an immutable view of the document which
+// remains valid while the user goes on typing.
+namespace Editor {
+class LineTree {
+public:
+	LineTree();
+	size_t size() const { return _root->count; }
+	bool empty() const { return 0 == size(); }
+	const Line &operator[](size_t index) const;
+	// Replace the text of an existing line.
+	void set(size_t index, Line text);
+	// Insert a new line, which will then have the specified index.
+	void insert(size_t index, Line text);
+	void push_back(Line text) { insert(size(), std::move(text)); }
+	// Insert a whole series of lines at once, the first of which will then
+	// have the specified index. This costs time in proportion to the number
+	// of lines inserted, plus the height of the tree, however many there are.
+	void insert(size_t index, std::vector<Line> lines);
+	// Remove the lines from begin up to but not including end.
+	void erase(size_t begin, size_t end);
+	void clear();
+	// Summarize the text of all the lines, in order, as a single hash. Each
+	// node remembers the hash of its subtree until something beneath it
+	// changes, so after an edit, only the path down to the edited leaf must
+	// be hashed again. Only the thread which edits the tree may ask.
+	uint64_t digest() const;
+
+	// Walk through the lines in order, one leaf chunk at a time, without
+	// searching down from the root for every line.
+	class const_iterator {
+	public:
+		const Line &operator*() const { return (*_chunk)[_offset]; }
+		const Line *operator->() const { return &**this; }
+		const_iterator &operator++();
+		bool operator==(const const_iterator &o) const;
+		bool operator!=(const const_iterator &o) const { return !(*this == o); }
+	private:
+		friend class LineTree;
+		const_iterator(const LineTree &tree, size_t index);
+		const LineTree *_tree = nullptr;
+		size_t _index = 0;
+		const std::vector<Line> *_chunk = nullptr;
+		size_t _offset = 0;
+	};
+	const_iterator begin() const { return const_iterator(*this, 0); }
+	const_iterator end() const { return const_iterator(*this, size()); }
+	const_iterator at(size_t index) const { return const_iterator(*this, index); }
+
+private:
+	struct Node {
+		bool leaf() const { return children.empty(); }
+		// how many lines are stored in this subtree?
+		size_t count = 0;
+		// a leaf node holds lines; a branch node holds other nodes
+		std::vector<Line> lines;
+		std::vector<std::shared_ptr<Node>> children;
+		// the hash of the subtree's lines, if known, and the factor which
+		// shifts it past them when combining it with the following lines
+		mutable bool hashed = false;
+		mutable uint64_t hash = 0;
+		mutable uint64_t power = 1;
+	};
+	typedef std::shared_ptr<Node> NodePtr;
+	const Node &find(size_t &index) const;
+	Node &find_mutable(size_t &index);
+	static Node &own(NodePtr &node);
+	NodePtr insert(Node &node, size_t index, Line &&text);
+	typedef std::vector<Line>::iterator LineIter;
+	std::vector<NodePtr> splice(
+			Node &node, size_t index, LineIter begin, LineIter end);
+	static std::vector<NodePtr> divide(Node &node);
+	void erase(Node &node, size_t index, size_t count);
+	void rebalance(Node &node);
+	void collapse();
+	static void rehash(const Node &node);
+	NodePtr _root;
+};
+} // namespace Editor
+
+#endif // EDITOR_LINETREE_H
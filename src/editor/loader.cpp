@@ -0,0 +1,116 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/loader.h"
+#include "editor/lineindex.h"
+#include <cstring>
+#include <signal.h>
+#include <unistd.h>
+
+namespace {
+// The worker hands its lines over in blocks of this many bytes.
+const size_t kBlockSize = 4 * 1024 * 1024;
+} // namespace
+
+Editor::Loader::Loader(
+		std::shared_ptr<Mapping> source, size_t begin, const Hash &hash):
+		_source(source),
+		_begin(begin),
+		_hash(hash),
+		_scanned(begin),
+		_cancel(false),
+		_thread(&Loader::run, this) {
+}
+
+Editor::Loader::~Loader() {
+	// Closing the editor before the file has finished loading abandons the
+	// rest of the work.
+	_cancel.store(true);
+	_thread.join();
+}
+
+size_t Editor::Loader::scan(const Mapping &source, size_t begin, size_t limit,
+		std::vector<Line> &lines, Profile &profile) {
+	// Stretch the block out to the next linebreak after the limit, so that
+	// the block will contain only whole lines.
+	const char *data = source.data();
+	size_t size = source.size();
+	size_t end = std::min(size, begin + limit);
+	if (end < size) {
+		const void *nl = memchr(data + end, '\x0A', size - end);
+		end = nl? static_cast<const char*>(nl) - data + 1: size;
+	}
+	LineIndex index;
+	index.scan(data + begin, end - begin);
+	profile.binary = profile.binary || index.nul();
+	lines.reserve(lines.size() + index.size());
+	for (size_t i = 0; i < index.size(); ++i) {
+		// We will read every file using LF as delimiter. When reading a
+		// Windows formatted text file, we will then strip the trailing CR,
+		// but the profile remembers it was there.
+		const char *head = data + begin + index.begin(i);
+		const char *tail = data + begin + index.end(i);
+		auto ending = Profile::EOL::LF;
+		if (tail == data + end) ending = Profile::EOL::None;
+		if (tail > head && tail[-1] == '\x0D') {
+			--tail;
+			if (ending == Profile::EOL::LF) ending = Profile::EOL::CRLF;
+		}
+		lines.emplace_back(head, tail - head);
+		profile.line(lines.back(), ending);
+	}
+	return end;
+}
+
+bool Editor::Loader::take(std::vector<Line> &lines, Profile &profile) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	lines.swap(_pending);
+	_pending.clear();
+	profile.merge(_profile);
+	_profile = Profile();
+	return _done;
+}
+
+Editor::Hash Editor::Loader::hash() {
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _hash;
+}
+
+unsigned Editor::Loader::progress() const {
+	return (unsigned)(_scanned.load() * 100 / _source->size());
+}
+
+void Editor::Loader::run() {
+	size_t pos = _begin;
+	while (pos < _source->size() && !_cancel.load()) {
+		std::vector<Line> lines;
+		Profile profile;
+		size_t begin = pos;
+		pos = scan(*_source, pos, kBlockSize, lines, profile);
+		_scanned.store(pos);
+		std::lock_guard<std::mutex> lock(_mutex);
+		_hash.update(_source->data() + begin, pos - begin);
+		for (auto &line: lines) {
+			_pending.push_back(std::move(line));
+		}
+		_profile.merge(profile);
+		_done = pos >= _source->size();
+		// Let the main loop know there is something to poll for, the same
+		// way a subprocess does when it has output for the console.
+		kill(getpid(), SIGIO);
+	}
+}
@@ -0,0 +1,68 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#ifndef EDITOR_LOADER_H
+#define EDITOR_LOADER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "editor/hash.h"
+#include "editor/line.h"
+#include "editor/mapping.h"
+#include "editor/profile.h"
+
+// A loader indexes the remainder of a large mapped file on a worker thread,
+// so the editor can show the beginning of the file while the kernel is still
+// paging in the end of it. The document collects the lines as they arrive.
+namespace Editor {
+class Loader {
+public:
+	// The hash covers the bytes before the beginning; the worker will add
+	// the rest of the file to it as it goes.
+	Loader(std::shared_ptr<Mapping> source, size_t begin, const Hash &hash);
+	~Loader();
+	// Index the block of lines beginning at this offset, adding them to the
+	// profile, and return the offset where the next block begins.
+	static size_t scan(const Mapping &source, size_t begin, size_t limit,
+			std::vector<Line> &lines, Profile &profile);
+	// Move whatever lines have been indexed into the vector, and add what we
+	// learned about them to the profile; return true if the worker has
+	// reached the end of the file.
+	bool take(std::vector<Line> &lines, Profile &profile);
+	unsigned progress() const;
+	// The hash of every byte indexed so far, which is the whole file once
+	// the worker is done.
+	Hash hash();
+private:
+	void run();
+	std::shared_ptr<Mapping> _source;
+	size_t _begin;
+	std::mutex _mutex;
+	std::vector<Line> _pending;
+	Profile _profile;
+	Hash _hash;
+	bool _done = false;
+	std::atomic<size_t> _scanned;
+	std::atomic_bool _cancel;
+	std::thread _thread;
+};
+} // namespace Editor
+
+#endif // EDITOR_LOADER_H
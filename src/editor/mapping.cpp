@@ -0,0 +1,263 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/mapping.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+// Files this small are cheaper to read than to map, and a private copy can't
+// change underneath us when some other program rewrites the file.
+const size_t kCopySize = 1024 * 1024;
+
+// Some other program may truncate a file we have mapped, and the kernel
+// answers any touch of a page past its new end with SIGBUS. We keep a list
+// of the file mappings, so the handler can tell our faults from anyone
+// else's, and paper over the missing pages with zeros; the watcher will
+// notice the change soon enough and the document will read the file again.
+// The handler can't take a lock, so the list is a fixed array of slots.
+const size_t kGuards = 256;
+std::atomic<uintptr_t> guard_begin[kGuards];
+std::atomic<uintptr_t> guard_end[kGuards];
+uintptr_t page_size;
+struct sigaction prior_sigbus;
+
+void on_sigbus(int, siginfo_t *info, void*) {
+	uintptr_t addr = reinterpret_cast<uintptr_t>(info->si_addr);
+	for (size_t i = 0; i < kGuards; ++i) {
+		uintptr_t begin = guard_begin[i].load();
+		uintptr_t end = guard_end[i].load();
+		if (addr < begin || addr >= end) continue;
+		void *page = reinterpret_cast<void*>(addr & ~(page_size - 1));
+		int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED;
+		if (MAP_FAILED != mmap(page, page_size, PROT_READ, flags, -1, 0)) {
+			return;
+		}
+		break;
+	}
+	// Not one of ours, so put back whatever was there before; a real fault
+	// will happen again as soon as we return, and get the usual treatment,
+	// but a signal somebody sent us must be sent again.
+	sigaction(SIGBUS, &prior_sigbus, nullptr);
+	if (info->si_code <= 0) raise(SIGBUS);
+}
+
+bool guard(void *base, size_t length) {
+	static std::once_flag installed;
+	std::call_once(installed, [] {
+		page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+		struct sigaction sa = {};
+		sa.sa_sigaction = on_sigbus;
+		sa.sa_flags = SA_SIGINFO | SA_NODEFER;
+		sigemptyset(&sa.sa_mask);
+		sigaction(SIGBUS, &sa, &prior_sigbus);
+	});
+	uintptr_t begin = reinterpret_cast<uintptr_t>(base);
+	for (size_t i = 0; i < kGuards; ++i) {
+		uintptr_t empty = 0;
+		if (guard_begin[i].compare_exchange_strong(empty, begin)) {
+			guard_end[i].store(begin + length);
+			return true;
+		}
+	}
+	return false;
+}
+
+void unguard(void *base) {
+	uintptr_t begin = reinterpret_cast<uintptr_t>(base);
+	for (size_t i = 0; i < kGuards; ++i) {
+		if (guard_begin[i].load() != begin) continue;
+		guard_end[i].store(0);
+		guard_begin[i].store(0);
+		return;
+	}
+}
+} // namespace
+
+Editor::Mapping::Mapping(std::string path, Charset fallback) {
+	_charset = fallback;
+	int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) return;
+	struct stat sb;
+	// An empty file cannot be mapped, but it has no lines to offer anyway.
+	if (0 == fstat(fd, &sb) && S_ISREG(sb.st_mode) && sb.st_size > 0) {
+		size_t size = static_cast<size_t>(sb.st_size);
+		if (size < kCopySize || !map(fd, size)) {
+			copy(fd, size);
+		}
+	}
+	// A copy keeps nothing of the file, but a mapping keeps its own
+	// reference, along with our own descriptor, for checking on it later.
+	if (_anonymous || !_data) {
+		close(fd);
+	} else {
+		_fd = fd;
+		_info = sb;
+	}
+	if (!_data) return;
+	size_t bom = 0;
+	_charset = detect(_data, _size, fallback, bom);
+	_bom = bom > 0;
+	switch (_charset) {
+		case Charset::UTF8:
+		case Charset::UTF8BOM:
+			// The lines can still be slices of the file; we need only step
+			// over the byte order mark.
+			_data += bom;
+			_size -= bom;
+			break;
+		default: transcode(_data + bom, _size - bom);
+	}
+}
+
+Editor::Mapping::~Mapping() {
+	if (_base) {
+		if (!_anonymous) unguard(_base);
+		munmap(_base, _length);
+	}
+	if (_fd >= 0) close(_fd);
+}
+
+bool Editor::Mapping::changed() const {
+	if (_fd < 0) return false;
+	struct stat sb;
+	if (fstat(_fd, &sb)) return true;
+	return sb.st_size != _info.st_size ||
+			sb.st_mtim.tv_sec != _info.st_mtim.tv_sec ||
+			sb.st_mtim.tv_nsec != _info.st_mtim.tv_nsec;
+}
+
+void Editor::Mapping::acknowledge() {
+	if (_fd >= 0) fstat(_fd, &_info);
+}
+
+bool Editor::Mapping::detach() {
+	if (_anonymous || !_base) return true;
+	// Copy the pages, then move the copy over the file mapping in one step,
+	// so that anyone reading the lines meanwhile sees the same bytes either
+	// way. Pages the file has lost already come back as zeros, just as they
+	// would have if we had left them alone.
+	int prot = PROT_READ | PROT_WRITE;
+	int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+	void *addr = mmap(nullptr, _length, prot, flags, -1, 0);
+	if (addr == MAP_FAILED) return false;
+	// The copy happens on the first keystroke, and it faults in far fewer
+	// pages if they can be huge ones.
+	madvise(addr, _length, MADV_HUGEPAGE);
+	memcpy(addr, _base, _length);
+	mprotect(addr, _length, PROT_READ);
+	flags = MREMAP_MAYMOVE | MREMAP_FIXED;
+	if (MAP_FAILED == mremap(addr, _length, _length, flags, _base)) {
+		munmap(addr, _length);
+		return false;
+	}
+	unguard(_base);
+	_anonymous = true;
+	close(_fd);
+	_fd = -1;
+	return true;
+}
+
+bool Editor::Mapping::map(int fd, size_t size) {
+	void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (addr == MAP_FAILED) return false;
+	// Without a guard, a file which shrank underneath us would crash the
+	// editor, so we would rather make a copy.
+	if (!guard(addr, size)) {
+		munmap(addr, size);
+		return false;
+	}
+	_base = addr;
+	_length = size;
+	_data = static_cast<const char*>(addr);
+	_size = size;
+	return true;
+}
+
+void Editor::Mapping::copy(int fd, size_t size) {
+	int prot = PROT_READ | PROT_WRITE;
+	void *addr = mmap(nullptr, size, prot, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (addr == MAP_FAILED) return;
+	char *dest = static_cast<char*>(addr);
+	size_t done = 0;
+	while (done < size) {
+		ssize_t got = pread(fd, dest + done, size - done, done);
+		if (got < 0 && errno == EINTR) continue;
+		if (got <= 0) break;
+		done += static_cast<size_t>(got);
+	}
+	// The file may have shrunk since we looked at it; what we got is what
+	// it holds now.
+	if (done == 0) {
+		munmap(addr, size);
+		return;
+	}
+	mprotect(addr, size, PROT_READ);
+	_base = addr;
+	_length = size;
+	_data = dest;
+	_size = done;
+	_anonymous = true;
+}
+
+void Editor::Mapping::transcode(const char *source, size_t size) {
+	// Decode into a private anonymous mapping, which then takes the place of
+	// the file, so the rest of the editor never knows the difference.
+	size_t length = std::max<size_t>(decoded_bound(_charset, size), 1);
+	int prot = PROT_READ | PROT_WRITE;
+	void *addr = mmap(nullptr, length, prot, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (!_anonymous) unguard(_base);
+	if (_fd >= 0) close(_fd);
+	_fd = -1;
+	if (addr == MAP_FAILED) {
+		munmap(_base, _length);
+		_base = nullptr;
+		_data = nullptr;
+		_length = _size = 0;
+		return;
+	}
+	size_t decoded = decode(_charset, source, size, static_cast<char*>(addr));
+	mprotect(addr, length, PROT_READ);
+	munmap(_base, _length);
+	_base = addr;
+	_length = length;
+	_data = static_cast<const char*>(addr);
+	_size = decoded;
+	_anonymous = true;
+}
+
+void Editor::Mapping::release(size_t begin, size_t end) const {
+	if (_anonymous) return;
+	// Only whole pages can go. Rounding outward may take a few bytes from
+	// a neighbor, but they will be read back in just as easily.
+	static const uintptr_t page = sysconf(_SC_PAGESIZE);
+	uintptr_t low = (uintptr_t)(_data + begin) & ~(page - 1);
+	uintptr_t high = (uintptr_t)(_data + std::min(end, _size));
+	high = (high + page - 1) & ~(page - 1);
+	if (low < high) {
+		madvise((void*)low, high - low, MADV_DONTNEED);
+	}
+}
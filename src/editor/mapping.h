@@ -0,0 +1,82 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#ifndef EDITOR_MAPPING_H
+#define EDITOR_MAPPING_H
+
+#include <string>
+#include <sys/stat.h>
+#include "editor/charset.h"
+
+// A mapping makes the contents of a file available in memory without reading
+// it in up front; the kernel pages the bytes in as we touch them. Lines loaded
+// from a mapped file remain slices of the mapping until someone edits them.
+// A file in some charset other than UTF-8 is transcoded instead, into an
+// anonymous mapping which stands in for the file; a small file is simply
+// copied, since there is little to gain by mapping it. Should another program
+// truncate a mapped file, the pages it lost read back as zeros; should it
+// rewrite the file in place, the mapping changes along with it, so a document
+// detaches its mapping from the file before it lets anyone edit the lines.
+namespace Editor {
+class Mapping {
+public:
+	Mapping(std::string path, Charset fallback = Charset::UTF8);
+	~Mapping();
+	Mapping(const Mapping&) = delete;
+	Mapping &operator=(const Mapping&) = delete;
+	bool valid() const { return _data != nullptr; }
+	const char *data() const { return _data; }
+	size_t size() const { return _size; }
+	// How was the file encoded, and did it begin with a byte order mark?
+	Charset charset() const { return _charset; }
+	bool bom() const { return _bom; }
+	// Has the file changed underneath the mapping since we mapped it? Once
+	// the mapping is detached, or if it never read from the file at all,
+	// nothing the file does can change it.
+	bool changed() const;
+	// The file has changed, but not the part of it we mapped, as when
+	// something appends to it or merely touches it; measure any further
+	// changes from the file as it is now.
+	void acknowledge();
+	// Copy the bytes into memory of our own, at the same addresses, so that
+	// slices of the mapping hold still from now on, whatever happens to the
+	// file; returns false if there was no memory for the copy.
+	bool detach();
+	// We are done looking at this range of bytes for now, so the kernel may
+	// reclaim the memory holding it; if we come back, the bytes will be read
+	// in from the file again. Text we had to copy or transcode has no file to
+	// come from, so it stays put.
+	void release(size_t begin, size_t end) const;
+private:
+	bool map(int fd, size_t size);
+	void copy(int fd, size_t size);
+	void transcode(const char *source, size_t size);
+	// A mapping attached to its file keeps it open, so we can tell whether
+	// it has been rewritten since we looked.
+	int _fd = -1;
+	struct stat _info = {};
+	void *_base = nullptr;
+	size_t _length = 0;
+	const char *_data = nullptr;
+	size_t _size = 0;
+	Charset _charset = Charset::UTF8;
+	bool _bom = false;
+	bool _anonymous = false;
+};
+} // namespace Editor
+
+#endif // EDITOR_MAPPING_H
@@ -0,0 +1,52 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#ifndef EDITOR_OBSERVER_H
+#define EDITOR_OBSERVER_H
+
+#include <cstddef>
+#include "editor/coordinates.h"
+
+// An observer hears about every change to a document as it happens, so that
+// anything derived from the document's lines can be brought up to date by
+// looking at only the lines which changed.
+namespace Editor {
+// A delta describes one change in terms of whole lines: the lines beginning
+// at the given index, up to but not including index + removed, have been
+// replaced by some number of new lines. Inserting text within a line removes
+// that line and adds one, for example, while splitting it adds two. The
+// version is the document's version once the change has been made.
+struct Delta {
+	enum class Kind {
+		Insert,
+		Erase,
+		Split
+	} kind;
+	unsigned long version;
+	line_t index;
+	size_t removed;
+	size_t added;
+};
+
+class Observer {
+public:
+	virtual ~Observer() = default;
+	virtual void changed(const Delta &delta) = 0;
+};
+} // namespace Editor
+
+#endif // EDITOR_OBSERVER_H
@@ -0,0 +1,139 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/pager.h"
+#include "editor/lineindex.h"
+#include <algorithm>
+#include <cstring>
+#include <signal.h>
+#include <unistd.h>
+
+namespace {
+// Checkpoints fall at the beginning of every kStride lines, and a window
+// holds the lines from one checkpoint to the next. Keeping a few windows
+// around covers a screen which straddles two of them, plus a little slack.
+const size_t kStride = 1024;
+const size_t kWindows = 4;
+// The worker indexes the file in blocks of this many bytes.
+const size_t kBlockSize = 4 * 1024 * 1024;
+} // namespace
+
+Editor::Pager::Pager(std::shared_ptr<Mapping> source):
+		_source(source),
+		_scanned(0),
+		_cancel(false),
+		_thread(&Pager::run, this) {
+}
+
+Editor::Pager::~Pager() {
+	_cancel.store(true);
+	_thread.join();
+}
+
+bool Editor::Pager::poll() {
+	std::lock_guard<std::mutex> lock(_mutex);
+	_checkpoints.insert(_checkpoints.end(), _pending.begin(), _pending.end());
+	_pending.clear();
+	_count = _pending_count;
+	_done = _pending_done;
+	return _done;
+}
+
+unsigned Editor::Pager::progress() const {
+	return (unsigned)(_scanned.load() * 100 / _source->size());
+}
+
+Editor::Line Editor::Pager::line(size_t index) {
+	Window &win = window(index / kStride);
+	return win.lines[index - win.first];
+}
+
+Editor::Pager::Window &Editor::Pager::window(size_t number) {
+	size_t first = number * kStride;
+	size_t count = std::min(kStride, _count - first);
+	for (auto iter = _windows.begin(); iter != _windows.end(); ++iter) {
+		if (iter->first != first) continue;
+		// The last window may have been read before the worker found all
+		// of its lines.
+		if (iter->lines.size() < count) read(*iter, first);
+		std::rotate(_windows.begin(), iter, iter + 1);
+		return _windows.front();
+	}
+	if (_windows.size() < kWindows) {
+		_windows.emplace_back();
+	} else {
+		Window &old = _windows.back();
+		_source->release(old.begin, old.end);
+	}
+	std::rotate(_windows.begin(), _windows.end() - 1, _windows.end());
+	read(_windows.front(), first);
+	return _windows.front();
+}
+
+void Editor::Pager::read(Window &win, size_t first) {
+	// Index the lines from the checkpoint onward, the same way the loader
+	// would have, stopping at the next checkpoint or the last line found.
+	const char *data = _source->data();
+	size_t size = _source->size();
+	size_t count = std::min(kStride, _count - first);
+	win.first = first;
+	win.begin = _checkpoints[first / kStride];
+	win.lines.clear();
+	win.lines.reserve(count);
+	size_t pos = win.begin;
+	while (win.lines.size() < count) {
+		const void *nl = memchr(data + pos, '\x0A', size - pos);
+		size_t end = nl? static_cast<const char*>(nl) - data: size;
+		size_t tail = end;
+		if (tail > pos && data[tail - 1] == '\x0D') --tail;
+		win.lines.emplace_back(data + pos, tail - pos);
+		pos = std::min(end + 1, size);
+	}
+	win.end = pos;
+}
+
+void Editor::Pager::run() {
+	const char *data = _source->data();
+	size_t size = _source->size();
+	size_t pos = 0;
+	size_t count = 0;
+	while (pos < size && !_cancel.load()) {
+		// Blocks end on a linebreak, as the loader's do.
+		size_t end = std::min(size, pos + kBlockSize);
+		if (end < size) {
+			const void *nl = memchr(data + end, '\x0A', size - end);
+			end = nl? static_cast<const char*>(nl) - data + 1: size;
+		}
+		LineIndex index;
+		index.scan(data + pos, end - pos);
+		std::vector<size_t> marks;
+		size_t next = (kStride - count % kStride) % kStride;
+		for (size_t i = next; i < index.size(); i += kStride) {
+			marks.push_back(pos + index.begin(i));
+		}
+		count += index.size();
+		// We won't need these pages again until someone scrolls to them.
+		_source->release(pos, end);
+		pos = end;
+		_scanned.store(pos);
+		std::lock_guard<std::mutex> lock(_mutex);
+		_pending.insert(_pending.end(), marks.begin(), marks.end());
+		_pending_count = count;
+		_pending_done = pos >= size;
+		kill(getpid(), SIGIO);
+	}
+}
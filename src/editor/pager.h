@@ -0,0 +1,80 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#ifndef EDITOR_PAGER_H
+#define EDITOR_PAGER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "editor/line.h"
+#include "editor/mapping.h"
+
+// A pager offers the lines of a file too large to hold in memory, such as a
+// multi-gigabyte log. Rather than a line object for every line, a worker
+// thread records a checkpoint at the beginning of every so many lines; when
+// someone asks for a line, we find the checkpoint before it and index a
+// small window of lines from there. Only a few windows are kept at once, and
+// the pages behind the ones we let go are returned to the system.
+namespace Editor {
+class Pager {
+public:
+	Pager(std::shared_ptr<Mapping> source);
+	~Pager();
+	// Collect the checkpoints the worker has found so far. Returns true
+	// once the whole file has been indexed.
+	bool poll();
+	bool indexing() const { return !_done; }
+	unsigned progress() const;
+	// How many lines have been indexed so far?
+	size_t size() const { return _count; }
+	// The window holding the line may be read again or dropped to make room
+	// for another, so the caller gets a line of its own, which keeps its
+	// text alive as long as it needs to.
+	Line line(size_t index);
+private:
+	void run();
+	struct Window {
+		size_t first = 0;
+		size_t begin = 0;
+		size_t end = 0;
+		std::vector<Line> lines;
+	};
+	Window &window(size_t index);
+	void read(Window &win, size_t first);
+	std::shared_ptr<Mapping> _source;
+	// The offset of every kStride'th line, and the total number of lines,
+	// as far as the main thread knows.
+	std::vector<size_t> _checkpoints;
+	size_t _count = 0;
+	bool _done = false;
+	// Most recently used window first.
+	std::vector<Window> _windows;
+	// What the worker has found, waiting to be collected.
+	std::mutex _mutex;
+	std::vector<size_t> _pending;
+	size_t _pending_count = 0;
+	bool _pending_done = false;
+	std::atomic<size_t> _scanned;
+	std::atomic_bool _cancel;
+	std::thread _thread;
+};
+} // namespace Editor
+
+#endif // EDITOR_PAGER_H
@@ -0,0 +1,42 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/profile.h"
+
+void Editor::Profile::line(const Line &text, EOL ending) {
+	if (text.text_class() == TextClass::Invalid) ++invalid;
+	if (ending == EOL::LF) ++lf;
+	if (ending == EOL::CRLF) ++crlf;
+	++lines;
+	last = ending;
+}
+
+void Editor::Profile::merge(const Profile &other) {
+	lf += other.lf;
+	crlf += other.crlf;
+	if (other.lines) last = other.last;
+	lines += other.lines;
+	invalid += other.invalid;
+	binary = binary || other.binary;
+}
+
+Editor::Profile::EOL Editor::Profile::eol() const {
+	if (lf && crlf) return EOL::Mixed;
+	if (crlf) return EOL::CRLF;
+	if (lf) return EOL::LF;
+	return EOL::None;
+}
@@ -0,0 +1,55 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#ifndef EDITOR_PROFILE_H
+#define EDITOR_PROFILE_H
+
+#include <cstddef>
+#include "editor/line.h"
+
+// A profile summarizes what the loader learned about a file while it was
+// splitting it into lines anyway: how its lines end, and whether it looks like
+// text at all. Gathering this during the load saves the editor from scanning
+// the file again later.
+namespace Editor {
+struct Profile {
+	enum class EOL {
+		None,
+		LF,
+		CRLF,
+		Mixed
+	};
+	// How many lines ended with each kind of linebreak?
+	size_t lf = 0;
+	size_t crlf = 0;
+	// How many lines were there, and did the last of them end with a
+	// linebreak?
+	size_t lines = 0;
+	EOL last = EOL::None;
+	// How many lines were not well-formed UTF-8? Did we find any NULs, which
+	// no text file should contain?
+	size_t invalid = 0;
+	bool binary = false;
+
+	// Count a line, along with the linebreak which ended it, if any.
+	void line(const Line &text, EOL ending);
+	void merge(const Profile &other);
+	EOL eol() const;
+};
+} // namespace Editor
+
+#endif // EDITOR_PROFILE_H
@@ -0,0 +1,67 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/saver.h"
+#include "editor/writer.h"
+#include <stdexcept>
+#include <signal.h>
+#include <unistd.h>
+
+Editor::Saver::Saver(
+		const Snapshot &snapshot, std::string path, const Config &config):
+		_snapshot(snapshot),
+		_path(path),
+		_config(config),
+		_done(false),
+		_thread(&Saver::run, this) {
+}
+
+Editor::Saver::~Saver() {
+	// There is no safe way to abandon a save halfway, so we must let it run
+	// to completion.
+	if (_thread.joinable()) {
+		_thread.join();
+	}
+}
+
+bool Editor::Saver::finish(std::string &message) {
+	if (_thread.joinable()) {
+		_thread.join();
+	}
+	if (!_error.empty()) {
+		message = _error;
+		return false;
+	}
+	size_t count = _snapshot.size();
+	message = "Wrote " + std::to_string(count);
+	message += (count == 1)? " line": " lines";
+	return true;
+}
+
+void Editor::Saver::run() {
+	try {
+		write(_snapshot.lines(), _path, _config);
+	} catch (const std::exception &e) {
+		_error = e.what();
+	} catch (...) {
+		// Anything escaping the thread would take the whole editor with it.
+		_error = "Failed to write (unknown error)";
+	}
+	_done.store(true);
+	// Let the main loop know it should poll the editor for the result.
+	kill(getpid(), SIGIO);
+}
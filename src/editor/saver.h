@@ -0,0 +1,50 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#ifndef EDITOR_SAVER_H
+#define EDITOR_SAVER_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include "editor/config.h"
+#include "editor/snapshot.h"
+
+// A saver writes a snapshot of a document to disk on a worker thread, so the
+// user can keep typing while a large file goes out.
+namespace Editor {
+class Saver {
+public:
+	Saver(const Snapshot &snapshot, std::string path, const Config &config);
+	~Saver();
+	bool done() const { return _done.load(); }
+	// Wait for the worker to finish, then report what happened: true if the
+	// file was written, false if the message describes an error.
+	bool finish(std::string &message);
+private:
+	void run();
+	Snapshot _snapshot;
+	std::string _path;
+	Config _config;
+	std::string _error;
+	std::atomic_bool _done;
+	std::thread _thread;
+};
+} // namespace Editor
+
+#endif // EDITOR_SAVER_H
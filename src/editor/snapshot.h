@@ -0,0 +1,57 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#ifndef EDITOR_SNAPSHOT_H
+#define EDITOR_SNAPSHOT_H
+
+#include <memory>
+#include "editor/line.h"
+#include "editor/linetree.h"
+#include "editor/mapping.h"
+
+// A snapshot is an immutable view of a document as of some version. Taking
+// one costs no more than copying a pointer, since the snapshot shares its
+// line tree with the document; the document copies whatever part of the tree
+// it changes afterward, so the snapshot never notices. Snapshots are safe to
+// hand to a worker thread, which may read from one for as long as it likes
+// while the user goes on editing.
+namespace Editor {
+class Snapshot {
+public:
+	Snapshot() {}
+	Snapshot(const LineTree &lines, std::shared_ptr<Mapping> source,
+			unsigned long version):
+			_lines(lines), _source(source), _version(version) {}
+	// Which version of the document does this snapshot represent? Later
+	// versions have larger numbers.
+	unsigned long version() const { return _version; }
+	size_t size() const { return _lines.size(); }
+	bool empty() const { return _lines.empty(); }
+	const Line &line(size_t index) const;
+	const LineTree &lines() const { return _lines; }
+	LineTree::const_iterator begin() const { return _lines.begin(); }
+	LineTree::const_iterator end() const { return _lines.end(); }
+private:
+	LineTree _lines;
+	// Lines which are still slices of the document's file need the mapping
+	// to outlive them, so we hold on to it too.
+	std::shared_ptr<Mapping> _source;
+	unsigned long _version = 0;
+};
+} // namespace Editor
+
+#endif // EDITOR_SNAPSHOT_H
@@ -0,0 +1,47 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/splitter.h"
+#include <cstring>
+
+void Editor::Splitter::feed(
+		const char *data, size_t size, std::vector<Line> &lines) {
+	const char *pos = data;
+	const char *end = data + size;
+	while (pos < end) {
+		auto brk = static_cast<const char*>(memchr(pos, '\x0A', end - pos));
+		if (!brk) break;
+		const char *stop = brk;
+		if (_partial.empty()) {
+			if (stop > pos && stop[-1] == '\x0D') --stop;
+			lines.emplace_back(pos, stop - pos, _arena);
+		} else {
+			_partial.append(pos, stop - pos);
+			if (_partial.back() == '\x0D') _partial.pop_back();
+			lines.emplace_back(_partial.data(), _partial.size(), _arena);
+			_partial.clear();
+		}
+		pos = brk + 1;
+	}
+	_partial.append(pos, end - pos);
+}
+
+void Editor::Splitter::finish(std::vector<Line> &lines) {
+	if (_partial.empty()) return;
+	lines.emplace_back(_partial.data(), _partial.size(), _arena);
+	_partial.clear();
+}
@@ -0,0 +1,45 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#ifndef EDITOR_SPLITTER_H
+#define EDITOR_SPLITTER_H
+
+#include <string>
+#include <vector>
+#include "editor/arena.h"
+#include "editor/line.h"
+
+// A splitter breaks up text which arrives a piece at a time, as it does from
+// a growing file or a pipe, and copies each whole line into its own arena. A
+// line whose linebreak has not arrived yet waits for the rest of its text.
+namespace Editor {
+class Splitter {
+public:
+	// Append each line this text completes to the vector. A CRLF linebreak
+	// counts as one, even if the two halves arrive separately.
+	void feed(const char *data, size_t size, std::vector<Line> &lines);
+	// Is there an unfinished line still waiting for its linebreak?
+	bool partial() const { return !_partial.empty(); }
+	// No more text is coming, so the unfinished line, if any, is the last.
+	void finish(std::vector<Line> &lines);
+private:
+	std::string _partial;
+	Arena _arena;
+};
+} // namespace Editor
+
+#endif // EDITOR_SPLITTER_H
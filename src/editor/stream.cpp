@@ -0,0 +1,81 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/stream.h"
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+
+namespace {
+// Read the pipe in pieces of this size, and no more than so many bytes per
+// poll; splitting that much text into lines takes a few milliseconds.
+const size_t kReadSize = 64 * 1024;
+const size_t kPollSize = 4 * 1024 * 1024;
+} // namespace
+
+Editor::Stream::Stream(int fd, std::string prefix):
+		_file(fd),
+		_prefix(std::move(prefix)) {
+	if (_file < 0) return;
+	fcntl(_file, F_SETFD, FD_CLOEXEC);
+	fcntl(_file, F_SETOWN, getpid());
+	int flags = fcntl(_file, F_GETFL);
+	if (flags >= 0) fcntl(_file, F_SETFL, flags | O_ASYNC | O_NONBLOCK);
+	_buffer.resize(kReadSize);
+}
+
+Editor::Stream::~Stream() {
+	if (_file >= 0) close(_file);
+}
+
+bool Editor::Stream::read(std::vector<Line> &lines) {
+	if (_done) return false;
+	size_t count = lines.size();
+	if (!_prefix.empty()) {
+		_splitter.feed(_prefix.data(), _prefix.size(), lines);
+		_size += _prefix.size();
+		std::string().swap(_prefix);
+	}
+	size_t budget = kPollSize;
+	while (_file >= 0 && budget > 0) {
+		ssize_t actual = ::read(_file, &_buffer[0], _buffer.size());
+		if (actual < 0 && errno == EINTR) continue;
+		if (actual < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+		if (actual <= 0) {
+			// The writer has gone away, or the pipe is broken; either way,
+			// there is nothing more to come.
+			close(_file);
+			_file = -1;
+			break;
+		}
+		_splitter.feed(_buffer.data(), actual, lines);
+		_size += actual;
+		budget -= std::min(budget, static_cast<size_t>(actual));
+	}
+	if (_file < 0) {
+		_splitter.finish(lines);
+		_done = true;
+		std::string().swap(_buffer);
+	} else if (budget == 0) {
+		// The writer is blocked on a full pipe, so it won't signal us again
+		// until we drain it.
+		kill(getpid(), SIGIO);
+	}
+	return lines.size() > count;
+}
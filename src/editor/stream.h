@@ -0,0 +1,59 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#ifndef EDITOR_STREAM_H
+#define EDITOR_STREAM_H
+
+#include <string>
+#include <vector>
+#include "editor/line.h"
+#include "editor/splitter.h"
+
+// A stream reads text from a pipe, such as our own standard input or the
+// output of a command, for as long as the other end keeps writing. Like the
+// pipes of a console subprocess, it never blocks, and it raises SIGIO when
+// more text arrives, so the main loop can pick up each chunk as it comes in.
+namespace Editor {
+class Stream {
+public:
+	// Take ownership of the file descriptor, which may be -1 if there is
+	// nothing left to read. The text somebody already read from it, if any,
+	// comes first.
+	Stream(int fd, std::string prefix = "");
+	~Stream();
+	Stream(const Stream&) = delete;
+	Stream &operator=(const Stream&) = delete;
+	// Collect the lines which have arrived since the last read, and return
+	// true if there were any. Each read takes only so much, so a fast writer
+	// can't keep the user waiting; if there may be more, we ask for another
+	// poll right away.
+	bool read(std::vector<Line> &lines);
+	// Has the writer closed its end, and have we collected everything?
+	bool done() const { return _done; }
+	// How many bytes have we read so far?
+	size_t size() const { return _size; }
+private:
+	int _file = -1;
+	std::string _prefix;
+	std::string _buffer;
+	size_t _size = 0;
+	bool _done = false;
+	Splitter _splitter;
+};
+} // namespace Editor
+
+#endif // EDITOR_STREAM_H
@@ -0,0 +1,93 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/styles.h"
+#include "app/regex.h"
+#include "ui/colors.h"
+#include <algorithm>
+#include <iterator>
+
+const std::vector<Editor::Styles::Run> &Editor::Styles::runs(
+		line_t index, const Line &text) {
+	auto iter = _entries.find(index);
+	// The line should be the very same one we styled before, sharing its
+	// text, unless some change got past us.
+	if (iter != _entries.end() && iter->second.text.same(text)) {
+		return iter->second.runs;
+	}
+	if (iter == _entries.end()) {
+		// Make room by dropping whichever end is farther from this line;
+		// the view has most likely scrolled away from it.
+		if (_entries.size() >= kCapacity) {
+			line_t low = _entries.begin()->first;
+			line_t high = _entries.rbegin()->first;
+			if (index - std::min(index, low) > std::max(index, high) - index) {
+				_entries.erase(_entries.begin());
+			} else {
+				_entries.erase(std::prev(_entries.end()));
+			}
+		}
+		iter = _entries.emplace(index, Entry()).first;
+	}
+	iter->second.text = text;
+	build(text, iter->second.runs);
+	return iter->second.runs;
+}
+
+void Editor::Styles::changed(const Delta &delta) {
+	auto first = _entries.lower_bound(delta.index);
+	auto last = _entries.lower_bound(delta.index + delta.removed);
+	_entries.erase(first, last);
+	if (delta.added == delta.removed) return;
+	// Every line after the change has a new index.
+	std::vector<std::pair<line_t, Entry>> moved;
+	first = _entries.lower_bound(delta.index);
+	for (auto iter = first; iter != _entries.end(); ++iter) {
+		line_t index = iter->first - delta.removed + delta.added;
+		moved.emplace_back(index, std::move(iter->second));
+	}
+	_entries.erase(first, _entries.end());
+	for (auto &entry: moved) {
+		_entries.emplace_hint(_entries.end(), entry.first,
+				std::move(entry.second));
+	}
+}
+
+void Editor::Styles::build(const Line &line, std::vector<Run> &runs) {
+	std::string text = line.str();
+	_scratch.assign(text.size(), 0);
+	static Regex trailing_space("[[:space:]]+$");
+	Regex::Match m = trailing_space.find(text);
+	if (!m.empty()) {
+		for (size_t i = m.begin; i < m.end; ++i) {
+			_scratch[i] = UI::Colors::error();
+		}
+	}
+	for (auto &token: Syntax::parse(_syntax, text)) {
+		for (size_t i = token.begin; i < token.end; ++i) {
+			_scratch[i] = token.style();
+		}
+	}
+	runs.clear();
+	for (size_t i = 0; i < _scratch.size(); ++i) {
+		if (runs.empty() || runs.back().style != _scratch[i]) {
+			runs.push_back({i + 1, _scratch[i]});
+		} else {
+			runs.back().end = i + 1;
+		}
+	}
+}
@@ -0,0 +1,61 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#ifndef EDITOR_STYLES_H
+#define EDITOR_STYLES_H
+
+#include <map>
+#include <vector>
+#include "app/syntax.h"
+#include "editor/coordinates.h"
+#include "editor/line.h"
+#include "editor/observer.h"
+
+// Painting a line means lexing it to find the style of each character, but
+// most repaints come from scrolling or moving the cursor, and show the same
+// lines again unchanged. We remember the styles of the lines we have painted
+// recently, as runs of characters sharing a style, and only lex a line again
+// once the document tells us it has changed.
+namespace Editor {
+class Styles {
+public:
+	Styles(const Syntax::Grammar &syntax): _syntax(syntax) {}
+	// Each run gives a style for the characters up to its end offset,
+	// beginning where the run before it ended.
+	struct Run {
+		offset_t end;
+		int style;
+	};
+	const std::vector<Run> &runs(line_t index, const Line &text);
+	// Forget the lines this change replaced, and move the ones after it.
+	void changed(const Delta &delta);
+	void clear() { _entries.clear(); }
+private:
+	void build(const Line &text, std::vector<Run> &runs);
+	const Syntax::Grammar &_syntax;
+	struct Entry {
+		Line text;
+		std::vector<Run> runs;
+	};
+	std::map<line_t, Entry> _entries;
+	std::vector<int> _scratch;
+	// enough for a few screens of lines around the one in view
+	static const size_t kCapacity = 512;
+};
+} // namespace Editor
+
+#endif // EDITOR_STYLES_H
@@ -0,0 +1,124 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/text.h"
+#include <algorithm>
+
+Editor::Text::Text(): _lines(1) {
+}
+
+Editor::Text::Text(std::string text) {
+	// The lines are born together and will probably die together, so they
+	// can share arena chunks rather than each taking a string of its own.
+	_lines.reserve(1 + std::count(text.begin(), text.end(), '\n'));
+	Arena arena;
+	size_t begin = 0, end = 0;
+	while ((end = text.find('\n', begin)) != std::string::npos) {
+		_lines.emplace_back(text.data() + begin, end - begin, arena);
+		begin = end + 1;
+	}
+	_lines.emplace_back(text.data() + begin, text.size() - begin, arena);
+	_tail = _lines.back().size();
+	_size = text.size();
+}
+
+Editor::Text::Text(std::vector<Line> lines, size_t head, size_t tail,
+		std::shared_ptr<Mapping> source):
+		_lines(std::move(lines)),
+		_head(head),
+		_tail(tail) {
+	if (_lines.empty()) {
+		_lines.resize(1);
+		_head = _tail = 0;
+	}
+	// Clamp the ends to their lines, the way a document sanitizes locations.
+	_tail = std::min(_tail, _lines.back().size());
+	_head = std::min(_head, _lines.front().size());
+	if (_lines.size() == 1) {
+		_head = std::min(_head, _tail);
+	}
+	for (size_t i = 0; i < _lines.size(); ++i) {
+		_size += line(i).size;
+	}
+	_size += _lines.size() - 1;
+	if (source) {
+		_sources.push_back(source);
+	}
+}
+
+Editor::Text::piece Editor::Text::const_iterator::operator*() const {
+	static const char linebreak = '\n';
+	if (_index & 1) return piece{&linebreak, 1};
+	return _text->line(_index / 2);
+}
+
+Editor::Text::piece Editor::Text::line(size_t index) const {
+	const Line &text = _lines[index];
+	size_t begin = (index == 0)? _head: 0;
+	size_t end = (index + 1 == _lines.size())? _tail: text.size();
+	return piece{text.data() + begin, end - begin};
+}
+
+Editor::Line Editor::Text::share(size_t index) const {
+	piece p = line(index);
+	const Line &text = _lines[index];
+	if (p.size == text.size()) return text;
+	return Line(std::string(p.data, p.size));
+}
+
+bool Editor::Text::borrows_only(const std::shared_ptr<Mapping> &source) const {
+	for (auto &other: _sources) {
+		if (other != source) return false;
+	}
+	return true;
+}
+
+std::string Editor::Text::str() const {
+	std::string out;
+	out.reserve(_size);
+	for (piece p: *this) {
+		out.append(p.data, p.size);
+	}
+	return out;
+}
+
+Editor::Text Editor::Text::operator+(const Text &other) const {
+	Text out;
+	out._lines.clear();
+	out._lines.reserve(_lines.size() + other._lines.size() - 1);
+	out._lines.insert(out._lines.end(), _lines.begin(), _lines.end() - 1);
+	// The last line of this text and the first line of the other become one.
+	piece left = line(_lines.size() - 1);
+	piece right = other.line(0);
+	std::string joint(left.data, left.size);
+	joint.append(right.data, right.size);
+	out._lines.emplace_back(std::move(joint));
+	out._lines.insert(out._lines.end(),
+			other._lines.begin() + 1, other._lines.end());
+	out._head = (_lines.size() > 1)? _head: 0;
+	out._tail = (other._lines.size() > 1)?
+			other._tail: out._lines.back().size();
+	out._size = _size + other._size;
+	out._sources = _sources;
+	for (auto &source: other._sources) {
+		auto &list = out._sources;
+		if (std::find(list.begin(), list.end(), source) == list.end()) {
+			list.push_back(source);
+		}
+	}
+	return out;
+}
@@ -0,0 +1,90 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#ifndef EDITOR_TEXT_H
+#define EDITOR_TEXT_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "editor/line.h"
+#include "editor/mapping.h"
+
+// A text is a run of characters lifted out of a document, for the clipboard
+// or the undo history. Rather than copying the characters, it shares the
+// document's lines, whose contents never change, and remembers where the
+// range began within its first line and ended within its last. Lines still
+// reading from a mapped file keep the mapping alive, so a text remains valid
+// after its document has gone away. Callers who need one contiguous string
+// can ask for it, but most can walk the pieces instead.
+namespace Editor {
+class Text {
+public:
+	struct piece {
+		const char *data;
+		size_t size;
+	};
+	class const_iterator {
+	public:
+		const_iterator(const Text *text, size_t index):
+				_text(text), _index(index) {}
+		piece operator*() const;
+		const_iterator &operator++() { ++_index; return *this; }
+		bool operator!=(const const_iterator &other) const {
+			return _index != other._index;
+		}
+	private:
+		const Text *_text;
+		size_t _index;
+	};
+	Text();
+	Text(std::string text);
+	Text(std::vector<Line> lines, size_t head, size_t tail,
+			std::shared_ptr<Mapping> source);
+	size_t size() const { return _size; }
+	bool empty() const { return 0 == _size; }
+	// How many lines does the text touch? This is one more than the number
+	// of linebreaks it contains.
+	size_t lines() const { return _lines.size(); }
+	// What part of this line belongs to the text?
+	piece line(size_t index) const;
+	// Get the part of this line belonging to the text as a line of its own,
+	// sharing storage unless the text begins or ends partway through it.
+	Line share(size_t index) const;
+	// Are all of the lines in this text safe to keep in a document which
+	// holds this mapping, because they are either strings or slices of it?
+	bool borrows_only(const std::shared_ptr<Mapping> &source) const;
+	// Walk the text as a sequence of pieces, with each linebreak a piece of
+	// its own, or flatten the whole thing into one string.
+	const_iterator begin() const { return const_iterator(this, 0); }
+	const_iterator end() const {
+		return const_iterator(this, 2 * _lines.size() - 1);
+	}
+	std::string str() const;
+	// Make a text from this one followed immediately by the other. Only the
+	// line where the two meet must be copied.
+	Text operator+(const Text &other) const;
+private:
+	std::vector<Line> _lines;
+	size_t _head = 0;
+	size_t _tail = 0;
+	size_t _size = 0;
+	std::vector<std::shared_ptr<Mapping>> _sources;
+};
+} // namespace Editor
+
+#endif // EDITOR_TEXT_H
@@ -30,12 +30,14 @@ void Editor::Update::at(location_t loc) {
 }
 
 void Editor::Update::at(line_t index) {
+	_generation++;
 	_start = _dirty? std::min(_start, index): index;
 	_end = _dirty? std::max(_end, index): index;
 	_dirty = true;
 }
 
 void Editor::Update::range(const Range &range) {
+	_generation++;
 	line_t a = range.begin().line;
 	line_t b = range.end().line;
 	line_t from = std::min(a, b);
@@ -46,12 +48,14 @@ void Editor::Update::range(const Range &range) {
 }
 
 void Editor::Update::forward(location_t loc) {
+	_generation++;
 	_start = _dirty? std::min(_start, loc.line): loc.line;
 	_end = SIZE_MAX;
 	_dirty = true;
 }
 
 void Editor::Update::all() {
+	_generation++;
 	_dirty = true;
 	_start = 0;
 	_end = SIZE_MAX;
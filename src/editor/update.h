@@ -31,7 +31,11 @@ public:
 	void all();
 	bool has_dirty() const { return _dirty; }
 	bool is_dirty(line_t index) const;
+	// This counts up every time some line is marked, so a cache can tell
+	// whether a line has been marked since the last time it looked.
+	unsigned long generation() const { return _generation; }
 private:
+	unsigned long _generation = 0;
 	bool _dirty = true;
 	line_t _start = 0;
 	line_t _end = 0;
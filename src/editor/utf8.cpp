@@ -0,0 +1,77 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/utf8.h"
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+size_t Editor::skip_ascii(const char *data, size_t pos, size_t size) {
+	// Sixteen bytes at a time, ASCII bytes are those with the high bit clear,
+	// so the movemask of a chunk tells us whether any byte in it is not.
+#if defined(__SSE2__)
+	for (; pos + 16 <= size; pos += 16) {
+		__m128i chunk = _mm_loadu_si128((const __m128i*)(data + pos));
+		unsigned mask = _mm_movemask_epi8(chunk);
+		if (mask) return pos + __builtin_ctz(mask);
+	}
+#endif
+	while (pos < size && 0 == (data[pos] & 0x80)) {
+		++pos;
+	}
+	return pos;
+}
+
+size_t Editor::sequence(const unsigned char *p, size_t avail) {
+	// A stray continuation, an overlong encoding, a surrogate, something
+	// beyond U+10FFFF, or a sequence cut short are all malformed.
+	unsigned char lead = p[0];
+	size_t len = 0;
+	unsigned char lo = 0x80, hi = 0xBF;
+	if (lead >= 0xC2 && lead <= 0xDF) {
+		len = 2;
+	} else if (lead >= 0xE0 && lead <= 0xEF) {
+		len = 3;
+		if (lead == 0xE0) lo = 0xA0;
+		if (lead == 0xED) hi = 0x9F;
+	} else if (lead >= 0xF0 && lead <= 0xF4) {
+		len = 4;
+		if (lead == 0xF0) lo = 0x90;
+		if (lead == 0xF4) hi = 0x8F;
+	} else {
+		return 0;
+	}
+	if (len > avail) return 0;
+	if (p[1] < lo || p[1] > hi) return 0;
+	for (size_t i = 2; i < len; ++i) {
+		if (0x80 != (p[i] & 0xC0)) return 0;
+	}
+	return len;
+}
+
+Editor::TextClass Editor::classify(const char *data, size_t size) {
+	bool ascii = true;
+	size_t pos = skip_ascii(data, 0, size);
+	while (pos < size) {
+		ascii = false;
+		const unsigned char *p = (const unsigned char*)data + pos;
+		size_t len = sequence(p, size - pos);
+		if (0 == len) return TextClass::Invalid;
+		pos = skip_ascii(data, pos + len, size);
+	}
+	return ascii? TextClass::ASCII: TextClass::UTF8;
+}
@@ -0,0 +1,42 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#ifndef EDITOR_UTF8_H
+#define EDITOR_UTF8_H
+
+#include <cstddef>
+
+// Most lines of most source files are plain ASCII, and there is no need to
+// decode those a character at a time. We classify each line once, when it is
+// created, so the document knows when it can step through a line one byte at
+// a time. Invalid lines still go through the careful decoder, which turns
+// malformed sequences into replacement characters.
+namespace Editor {
+enum class TextClass {
+	ASCII,
+	UTF8,
+	Invalid
+};
+TextClass classify(const char *data, size_t size);
+// Where does the run of ASCII bytes beginning at pos come to an end?
+size_t skip_ascii(const char *data, size_t pos, size_t size);
+// How long is the well-formed multibyte sequence beginning here? Zero means
+// it isn't one.
+size_t sequence(const unsigned char *p, size_t avail);
+} // namespace Editor
+
+#endif // EDITOR_UTF8_H
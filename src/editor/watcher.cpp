@@ -0,0 +1,126 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#include "editor/watcher.h"
+#include <algorithm>
+#include <map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace {
+const uint32_t kFileEvents =
+		IN_MODIFY | IN_CLOSE_WRITE | IN_MOVE_SELF | IN_DELETE_SELF;
+const uint32_t kDirEvents = IN_CREATE | IN_MOVED_TO | IN_CLOSE_WRITE;
+
+// The one inotify instance, opened by the first watcher, and kept until the
+// process exits. Two watchers looking at the same file, or at files in the
+// same directory, get the same watch descriptor back, so we count how many
+// are using each one and only remove it when the last of them is done.
+int s_notify = -1;
+std::map<int, size_t> s_watches;
+std::vector<Editor::Watcher*> s_watchers;
+
+int instance() {
+	if (s_notify >= 0) return s_notify;
+	s_notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (s_notify < 0) return s_notify;
+	// Ask for SIGIO when an event arrives, so the main loop will poll us.
+	fcntl(s_notify, F_SETOWN, getpid());
+	int flags = fcntl(s_notify, F_GETFL);
+	fcntl(s_notify, F_SETFL, flags | O_ASYNC | O_NONBLOCK);
+	return s_notify;
+}
+
+int add_watch(const std::string &path, uint32_t mask) {
+	int wd = inotify_add_watch(s_notify, path.c_str(), mask);
+	if (wd >= 0) s_watches[wd]++;
+	return wd;
+}
+
+void remove_watch(int wd) {
+	auto iter = s_watches.find(wd);
+	if (iter == s_watches.end()) return;
+	if (--iter->second) return;
+	inotify_rm_watch(s_notify, wd);
+	s_watches.erase(iter);
+}
+} // namespace
+
+Editor::Watcher::Watcher(std::string path): _path(path) {
+	size_t slash = path.find_last_of('/');
+	std::string dir = ".";
+	if (slash != std::string::npos) {
+		dir = slash? path.substr(0, slash): "/";
+		_name = path.substr(slash + 1);
+	} else {
+		_name = path;
+	}
+	if (instance() < 0) return;
+	_file = add_watch(path, kFileEvents);
+	_dir = add_watch(dir, kDirEvents | IN_ONLYDIR);
+	s_watchers.push_back(this);
+}
+
+Editor::Watcher::~Watcher() {
+	auto iter = std::find(s_watchers.begin(), s_watchers.end(), this);
+	if (iter != s_watchers.end()) s_watchers.erase(iter);
+	if (_file >= 0) remove_watch(_file);
+	if (_dir >= 0) remove_watch(_dir);
+}
+
+bool Editor::Watcher::changed() {
+	if (!valid()) return false;
+	// Use up every pending event, so the next one will raise another signal,
+	// and pass each one along to whichever watchers it concerns.
+	alignas(inotify_event) char buf[4096];
+	ssize_t actual;
+	while ((actual = read(s_notify, buf, sizeof(buf))) > 0) {
+		for (ssize_t pos = 0; pos < actual;) {
+			auto event = reinterpret_cast<const inotify_event*>(buf + pos);
+			pos += sizeof(inotify_event) + event->len;
+			for (auto watcher: s_watchers) {
+				watcher->notice(*event);
+			}
+			// The kernel has already dropped a watch whose file is gone.
+			if (event->mask & IN_IGNORED) s_watches.erase(event->wd);
+		}
+	}
+	if (_replaced) {
+		// The watch belongs to the old file, wherever it went; whatever now
+		// has its name is the file we care about.
+		if (_file >= 0) remove_watch(_file);
+		_file = add_watch(_path, kFileEvents);
+		_replaced = false;
+	}
+	bool out = _changed;
+	_changed = false;
+	return out;
+}
+
+void Editor::Watcher::notice(const inotify_event &event) {
+	if (event.wd == _file) {
+		_changed = true;
+		if (event.mask & (IN_MOVE_SELF | IN_DELETE_SELF | IN_IGNORED)) {
+			_replaced = true;
+		}
+	} else if (event.wd == _dir && event.len) {
+		if (_name != event.name) return;
+		_changed = true;
+		if (event.mask & (IN_CREATE | IN_MOVED_TO)) _replaced = true;
+	}
+}
@@ -0,0 +1,55 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#ifndef EDITOR_WATCHER_H
+#define EDITOR_WATCHER_H
+
+#include <string>
+
+struct inotify_event;
+
+// A watcher asks the kernel to tell us when something else changes the file
+// a document was read from. It watches the file itself, for writes, and its
+// directory, since many programs save a file by writing a new one and
+// renaming it into place. The kernel allows each user only a few inotify
+// instances, so every watcher in the process shares one, and whichever of
+// them polls first sorts out the events for the rest. Events raise SIGIO, the
+// same way a subprocess does when it has output for the console, so the main
+// loop will poll us.
+namespace Editor {
+class Watcher {
+public:
+	Watcher(std::string path);
+	~Watcher();
+	Watcher(const Watcher&) = delete;
+	Watcher &operator=(const Watcher&) = delete;
+	bool valid() const { return _file >= 0 || _dir >= 0; }
+	// Has anything happened to the file since the last time we asked? If it
+	// was replaced, we will go on watching the file which took its place.
+	bool changed();
+private:
+	void notice(const inotify_event &event);
+	std::string _path;
+	std::string _name;
+	int _file = -1;
+	int _dir = -1;
+	bool _changed = false;
+	bool _replaced = false;
+};
+} // namespace Editor
+
+#endif // EDITOR_WATCHER_H
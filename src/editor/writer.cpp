@@ -0,0 +1,190 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/writer.h"
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+// Collect output into blocks of this size, so that we make one write call
+// per megabyte instead of one per line.
+const size_t kBufferSize = 1024 * 1024;
+bool s_sync = true;
+
+std::runtime_error failure(int code) {
+	std::string err = "Failed to write (" + std::to_string(code);
+	err += ": " + std::string(std::strerror(code)) + ")";
+	return std::runtime_error(err);
+}
+
+std::runtime_error unencodable(size_t index, Editor::Charset charset) {
+	std::string err = "Failed to write (line " + std::to_string(index + 1);
+	err += " has characters " + std::string(Editor::name(charset));
+	err += " cannot represent)";
+	return std::runtime_error(err);
+}
+
+class Output {
+public:
+	Output(int fd): _fd(fd) { _buffer.reserve(kBufferSize); }
+	void append(const char *data, size_t size) {
+		if (_buffer.size() + size > kBufferSize) flush();
+		if (size >= kBufferSize) {
+			put(data, size);
+		} else {
+			_buffer.append(data, size);
+		}
+	}
+	void flush() {
+		put(_buffer.data(), _buffer.size());
+		_buffer.clear();
+	}
+private:
+	void put(const char *data, size_t size) {
+		while (size > 0) {
+			ssize_t actual = ::write(_fd, data, size);
+			if (actual < 0) {
+				if (errno == EINTR) continue;
+				throw failure(errno);
+			}
+			data += actual;
+			size -= actual;
+		}
+	}
+	int _fd;
+	std::string _buffer;
+};
+
+std::string resolve(std::string path) {
+	// If the target is a symlink, we want to replace the file it refers to,
+	// not the link itself.
+	if (char *real = realpath(path.c_str(), nullptr)) {
+		path = real;
+		free(real);
+	}
+	return path;
+}
+
+int create_temp(const std::string &path, std::string &temp) {
+	// The temporary file must live in the same directory as the target, or
+	// we could not rename it into place. Its permissions should match those
+	// of the file it will replace.
+	static std::atomic<unsigned> serial(0);
+	struct stat sb;
+	bool exists = 0 == stat(path.c_str(), &sb);
+	mode_t mode = exists? (sb.st_mode & 07777): 0666;
+	int fd = -1;
+	do {
+		temp = path + ".ozette-" + std::to_string(getpid());
+		temp += "-" + std::to_string(serial++);
+		fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, mode);
+	} while (fd < 0 && errno == EEXIST);
+	if (fd >= 0 && exists) {
+		// The new file should belong to the same owner and group as the old
+		// one. Only root can give a file away, so this usually fails, but
+		// then the file was probably ours to begin with. Changing the owner
+		// may clear the setuid bits, so the mode comes afterward. The umask
+		// has already been applied once, when we created the file.
+		int result = fchown(fd, sb.st_uid, sb.st_gid);
+		(void)result;
+		fchmod(fd, mode);
+	}
+	return fd;
+}
+
+void sync_dir(const std::string &path) {
+	// Make sure the rename itself is durable, not just the file contents.
+	size_t slash = path.find_last_of('/');
+	std::string dir = (slash == std::string::npos)? ".": path.substr(0, slash);
+	int fd = open(dir.empty()? "/": dir.c_str(), O_RDONLY | O_DIRECTORY);
+	if (fd >= 0) {
+		fsync(fd);
+		close(fd);
+	}
+}
+} // namespace
+
+void Editor::write(const LineTree &lines, std::string path, const Config &config) {
+	path = resolve(path);
+	std::string temp;
+	int fd = create_temp(path, temp);
+	if (fd < 0) throw failure(errno);
+	const char *eol = config.end_of_line();
+	size_t eol_size = strlen(eol);
+	bool trim = config.trim_trailing_whitespace();
+	bool final_newline = config.insert_final_newline();
+	Charset charset = config.charset();
+	bool transcode = charset != Charset::UTF8 && charset != Charset::UTF8BOM;
+	try {
+		Output out(fd);
+		if (config.byte_order_mark()) {
+			std::string bom = byte_order_mark(charset);
+			out.append(bom.data(), bom.size());
+		}
+		// Each line goes through the encoder on its way out, unless it is
+		// already in the right form.
+		std::string encoded, eol_encoded;
+		encode(charset, eol, eol_size, eol_encoded);
+		size_t remaining = lines.size();
+		size_t index = 0;
+		for (auto &line: lines) {
+			size_t size = line.size();
+			if (trim) {
+				while (size > 0 && isspace((unsigned char)line[size - 1])) {
+					--size;
+				}
+			}
+			if (transcode) {
+				encoded.clear();
+				if (!encode(charset, line.data(), size, encoded)) {
+					throw unencodable(index, charset);
+				}
+				out.append(encoded.data(), encoded.size());
+			} else {
+				out.append(line.data(), size);
+			}
+			if (--remaining > 0 || final_newline) {
+				out.append(eol_encoded.data(), eol_encoded.size());
+			}
+			++index;
+		}
+		out.flush();
+		if (s_sync && fsync(fd)) throw failure(errno);
+		int result = close(fd);
+		fd = -1;
+		if (result) throw failure(errno);
+		if (rename(temp.c_str(), path.c_str())) throw failure(errno);
+	} catch (...) {
+		int local_errno = errno;
+		if (fd >= 0) close(fd);
+		unlink(temp.c_str());
+		errno = local_errno;
+		throw;
+	}
+	if (s_sync) sync_dir(path);
+}
+
+void Editor::set_sync(bool sync) {
+	s_sync = sync;
+}
@@ -0,0 +1,37 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#ifndef EDITOR_WRITER_H
+#define EDITOR_WRITER_H
+
+#include <string>
+#include "editor/config.h"
+#include "editor/linetree.h"
+
+namespace Editor {
+// Write the lines out to the file at this path, formatted as the config
+// specifies. The text goes into a temporary file in the same directory, which
+// then replaces the target in a single rename, so that a failure along the way
+// can never leave a half-written file behind. Throws std::runtime_error.
+void write(const LineTree &lines, std::string path, const Config &config);
+// Should each write wait until the file has reached the disk? That is the
+// default, and the safest choice, but on a slow or busy disk it may hold up
+// every save for a second or more.
+void set_sync(bool sync);
+} // namespace Editor
+
+#endif // EDITOR_WRITER_H
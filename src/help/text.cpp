@@ -229,54 +229,87 @@ unsigned char HELP[] = {
   0x73, 0x74, 0x72, 0x69, 0x6e, 0x67, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x72,
   0x65, 0x70, 0x6c, 0x61, 0x63, 0x65, 0x20, 0x69, 0x74, 0x20, 0x77, 0x69,
   0x74, 0x68, 0x20, 0x61, 0x6e, 0x6f, 0x74, 0x68, 0x65, 0x72, 0x0a, 0x20,
-  0x20, 0x20, 0x20, 0x5e, 0x4c, 0x20, 0x2d, 0x20, 0x54, 0x6f, 0x20, 0x4c,
-  0x69, 0x6e, 0x65, 0x20, 0x2d, 0x20, 0x6d, 0x6f, 0x76, 0x65, 0x20, 0x74,
-  0x68, 0x65, 0x20, 0x63, 0x75, 0x72, 0x73, 0x6f, 0x72, 0x20, 0x74, 0x6f,
-  0x20, 0x74, 0x68, 0x65, 0x20, 0x62, 0x65, 0x67, 0x69, 0x6e, 0x6e, 0x69,
-  0x6e, 0x67, 0x20, 0x6f, 0x66, 0x20, 0x74, 0x68, 0x65, 0x20, 0x73, 0x70,
-  0x65, 0x63, 0x69, 0x66, 0x69, 0x65, 0x64, 0x20, 0x6c, 0x69, 0x6e, 0x65,
-  0x0a, 0x20, 0x20, 0x20, 0x20, 0x5e, 0x53, 0x20, 0x2d, 0x20, 0x53, 0x61,
-  0x76, 0x65, 0x20, 0x2d, 0x20, 0x77, 0x72, 0x69, 0x74, 0x65, 0x20, 0x74,
-  0x68, 0x65, 0x20, 0x63, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74, 0x73, 0x20,
-  0x6f, 0x66, 0x20, 0x74, 0x68, 0x65, 0x20, 0x62, 0x75, 0x66, 0x66, 0x65,
-  0x72, 0x20, 0x62, 0x61, 0x63, 0x6b, 0x20, 0x74, 0x6f, 0x20, 0x64, 0x69,
-  0x73, 0x6b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5e, 0x41, 0x20, 0x2d, 0x20,
-  0x53, 0x61, 0x76, 0x65, 0x20, 0x41, 0x73, 0x20, 0x2d, 0x20, 0x77, 0x72,
-  0x69, 0x74, 0x65, 0x20, 0x74, 0x68, 0x65, 0x20, 0x62, 0x75, 0x66, 0x66,
-  0x65, 0x72, 0x20, 0x74, 0x6f, 0x20, 0x64, 0x69, 0x73, 0x6b, 0x20, 0x75,
-  0x6e, 0x64, 0x65, 0x72, 0x20, 0x61, 0x20, 0x6e, 0x65, 0x77, 0x20, 0x6e,
-  0x61, 0x6d, 0x65, 0x2f, 0x6c, 0x6f, 0x63, 0x61, 0x74, 0x69, 0x6f, 0x6e,
-  0x0a, 0x20, 0x20, 0x20, 0x20, 0x5e, 0x5a, 0x20, 0x2d, 0x20, 0x55, 0x6e,
-  0x64, 0x6f, 0x20, 0x2d, 0x20, 0x72, 0x6f, 0x6c, 0x6c, 0x20, 0x62, 0x61,
-  0x63, 0x6b, 0x20, 0x74, 0x68, 0x65, 0x20, 0x6c, 0x61, 0x73, 0x74, 0x20,
-  0x63, 0x68, 0x61, 0x6e, 0x67, 0x65, 0x20, 0x74, 0x6f, 0x20, 0x74, 0x68,
-  0x65, 0x20, 0x64, 0x6f, 0x63, 0x75, 0x6d, 0x65, 0x6e, 0x74, 0x0a, 0x20,
-  0x20, 0x20, 0x20, 0x5e, 0x59, 0x20, 0x2d, 0x20, 0x52, 0x65, 0x64, 0x6f,
-  0x20, 0x2d, 0x20, 0x72, 0x65, 0x61, 0x70, 0x70, 0x6c, 0x79, 0x20, 0x74,
+  0x20, 0x20, 0x20, 0x5e, 0x55, 0x20, 0x2d, 0x20, 0x52, 0x65, 0x70, 0x6c,
+  0x61, 0x63, 0x65, 0x20, 0x41, 0x6c, 0x6c, 0x20, 0x2d, 0x20, 0x72, 0x65,
+  0x70, 0x6c, 0x61, 0x63, 0x65, 0x20, 0x65, 0x76, 0x65, 0x72, 0x79, 0x20,
+  0x6f, 0x63, 0x63, 0x75, 0x72, 0x72, 0x65, 0x6e, 0x63, 0x65, 0x20, 0x6f,
+  0x66, 0x20, 0x61, 0x20, 0x73, 0x74, 0x72, 0x69, 0x6e, 0x67, 0x20, 0x61,
+  0x74, 0x20, 0x6f, 0x6e, 0x63, 0x65, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5e,
+  0x4c, 0x20, 0x2d, 0x20, 0x54, 0x6f, 0x20, 0x4c, 0x69, 0x6e, 0x65, 0x20,
+  0x2d, 0x20, 0x6d, 0x6f, 0x76, 0x65, 0x20, 0x74, 0x68, 0x65, 0x20, 0x63,
+  0x75, 0x72, 0x73, 0x6f, 0x72, 0x20, 0x74, 0x6f, 0x20, 0x74, 0x68, 0x65,
+  0x20, 0x62, 0x65, 0x67, 0x69, 0x6e, 0x6e, 0x69, 0x6e, 0x67, 0x20, 0x6f,
+  0x66, 0x20, 0x74, 0x68, 0x65, 0x20, 0x73, 0x70, 0x65, 0x63, 0x69, 0x66,
+  0x69, 0x65, 0x64, 0x20, 0x6c, 0x69, 0x6e, 0x65, 0x0a, 0x20, 0x20, 0x20,
+  0x20, 0x5e, 0x53, 0x20, 0x2d, 0x20, 0x53, 0x61, 0x76, 0x65, 0x20, 0x2d,
+  0x20, 0x77, 0x72, 0x69, 0x74, 0x65, 0x20, 0x74, 0x68, 0x65, 0x20, 0x63,
+  0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74, 0x73, 0x20, 0x6f, 0x66, 0x20, 0x74,
+  0x68, 0x65, 0x20, 0x62, 0x75, 0x66, 0x66, 0x65, 0x72, 0x20, 0x62, 0x61,
+  0x63, 0x6b, 0x20, 0x74, 0x6f, 0x20, 0x64, 0x69, 0x73, 0x6b, 0x0a, 0x20,
+  0x20, 0x20, 0x20, 0x5e, 0x41, 0x20, 0x2d, 0x20, 0x53, 0x61, 0x76, 0x65,
+  0x20, 0x41, 0x73, 0x20, 0x2d, 0x20, 0x77, 0x72, 0x69, 0x74, 0x65, 0x20,
+  0x74, 0x68, 0x65, 0x20, 0x62, 0x75, 0x66, 0x66, 0x65, 0x72, 0x20, 0x74,
+  0x6f, 0x20, 0x64, 0x69, 0x73, 0x6b, 0x20, 0x75, 0x6e, 0x64, 0x65, 0x72,
+  0x20, 0x61, 0x20, 0x6e, 0x65, 0x77, 0x20, 0x6e, 0x61, 0x6d, 0x65, 0x2f,
+  0x6c, 0x6f, 0x63, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x0a, 0x20, 0x20, 0x20,
+  0x20, 0x5e, 0x5a, 0x20, 0x2d, 0x20, 0x55, 0x6e, 0x64, 0x6f, 0x20, 0x2d,
+  0x20, 0x72, 0x6f, 0x6c, 0x6c, 0x20, 0x62, 0x61, 0x63, 0x6b, 0x20, 0x74,
   0x68, 0x65, 0x20, 0x6c, 0x61, 0x73, 0x74, 0x20, 0x63, 0x68, 0x61, 0x6e,
-  0x67, 0x65, 0x20, 0x77, 0x68, 0x69, 0x63, 0x68, 0x20, 0x77, 0x61, 0x73,
-  0x20, 0x72, 0x6f, 0x6c, 0x6c, 0x65, 0x64, 0x20, 0x62, 0x61, 0x63, 0x6b,
-  0x0a, 0x0a, 0x0a, 0x3d, 0x3d, 0x20, 0x53, 0x68, 0x65, 0x6c, 0x6c, 0x20,
-  0x63, 0x6f, 0x6e, 0x73, 0x6f, 0x6c, 0x65, 0x0a, 0x0a, 0x54, 0x68, 0x65,
-  0x20, 0x63, 0x6f, 0x6e, 0x73, 0x6f, 0x6c, 0x65, 0x20, 0x64, 0x69, 0x73,
-  0x70, 0x6c, 0x61, 0x79, 0x73, 0x20, 0x6f, 0x75, 0x74, 0x70, 0x75, 0x74,
-  0x20, 0x6c, 0x6f, 0x67, 0x67, 0x65, 0x64, 0x20, 0x66, 0x72, 0x6f, 0x6d,
-  0x20, 0x63, 0x6f, 0x6d, 0x6d, 0x61, 0x6e, 0x64, 0x73, 0x20, 0x65, 0x78,
-  0x65, 0x63, 0x75, 0x74, 0x65, 0x64, 0x20, 0x61, 0x67, 0x61, 0x69, 0x6e,
-  0x73, 0x74, 0x20, 0x74, 0x68, 0x65, 0x20, 0x63, 0x75, 0x72, 0x72, 0x65,
-  0x6e, 0x74, 0x0a, 0x64, 0x69, 0x72, 0x65, 0x63, 0x74, 0x6f, 0x72, 0x79,
-  0x2e, 0x20, 0x54, 0x68, 0x65, 0x73, 0x65, 0x20, 0x6d, 0x61, 0x79, 0x20,
-  0x62, 0x65, 0x20, 0x62, 0x75, 0x69, 0x6c, 0x74, 0x2d, 0x69, 0x6e, 0x20,
-  0x63, 0x6f, 0x6d, 0x6d, 0x61, 0x6e, 0x64, 0x73, 0x20, 0x6c, 0x69, 0x6b,
-  0x65, 0x20, 0x46, 0x69, 0x6e, 0x64, 0x20, 0x6f, 0x72, 0x20, 0x73, 0x68,
-  0x65, 0x6c, 0x6c, 0x20, 0x63, 0x6f, 0x6d, 0x6d, 0x61, 0x6e, 0x64, 0x73,
-  0x20, 0x69, 0x6e, 0x76, 0x6f, 0x6b, 0x65, 0x64, 0x0a, 0x77, 0x69, 0x74,
-  0x68, 0x20, 0x45, 0x78, 0x65, 0x63, 0x75, 0x74, 0x65, 0x2e, 0x0a, 0x0a,
+  0x67, 0x65, 0x20, 0x74, 0x6f, 0x20, 0x74, 0x68, 0x65, 0x20, 0x64, 0x6f,
+  0x63, 0x75, 0x6d, 0x65, 0x6e, 0x74, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5e,
+  0x59, 0x20, 0x2d, 0x20, 0x52, 0x65, 0x64, 0x6f, 0x20, 0x2d, 0x20, 0x72,
+  0x65, 0x61, 0x70, 0x70, 0x6c, 0x79, 0x20, 0x74, 0x68, 0x65, 0x20, 0x6c,
+  0x61, 0x73, 0x74, 0x20, 0x63, 0x68, 0x61, 0x6e, 0x67, 0x65, 0x20, 0x77,
+  0x68, 0x69, 0x63, 0x68, 0x20, 0x77, 0x61, 0x73, 0x20, 0x72, 0x6f, 0x6c,
+  0x6c, 0x65, 0x64, 0x20, 0x62, 0x61, 0x63, 0x6b, 0x0a, 0x0a, 0x0a, 0x3d,
+  0x3d, 0x20, 0x53, 0x68, 0x65, 0x6c, 0x6c, 0x20, 0x63, 0x6f, 0x6e, 0x73,
+  0x6f, 0x6c, 0x65, 0x0a, 0x0a, 0x54, 0x68, 0x65, 0x20, 0x63, 0x6f, 0x6e,
+  0x73, 0x6f, 0x6c, 0x65, 0x20, 0x64, 0x69, 0x73, 0x70, 0x6c, 0x61, 0x79,
+  0x73, 0x20, 0x6f, 0x75, 0x74, 0x70, 0x75, 0x74, 0x20, 0x6c, 0x6f, 0x67,
+  0x67, 0x65, 0x64, 0x20, 0x66, 0x72, 0x6f, 0x6d, 0x20, 0x63, 0x6f, 0x6d,
+  0x6d, 0x61, 0x6e, 0x64, 0x73, 0x20, 0x65, 0x78, 0x65, 0x63, 0x75, 0x74,
+  0x65, 0x64, 0x20, 0x61, 0x67, 0x61, 0x69, 0x6e, 0x73, 0x74, 0x20, 0x74,
+  0x68, 0x65, 0x20, 0x63, 0x75, 0x72, 0x72, 0x65, 0x6e, 0x74, 0x0a, 0x64,
+  0x69, 0x72, 0x65, 0x63, 0x74, 0x6f, 0x72, 0x79, 0x2e, 0x20, 0x54, 0x68,
+  0x65, 0x73, 0x65, 0x20, 0x6d, 0x61, 0x79, 0x20, 0x62, 0x65, 0x20, 0x62,
+  0x75, 0x69, 0x6c, 0x74, 0x2d, 0x69, 0x6e, 0x20, 0x63, 0x6f, 0x6d, 0x6d,
+  0x61, 0x6e, 0x64, 0x73, 0x20, 0x6c, 0x69, 0x6b, 0x65, 0x20, 0x46, 0x69,
+  0x6e, 0x64, 0x20, 0x6f, 0x72, 0x20, 0x73, 0x68, 0x65, 0x6c, 0x6c, 0x20,
+  0x63, 0x6f, 0x6d, 0x6d, 0x61, 0x6e, 0x64, 0x73, 0x20, 0x69, 0x6e, 0x76,
+  0x6f, 0x6b, 0x65, 0x64, 0x0a, 0x77, 0x69, 0x74, 0x68, 0x20, 0x45, 0x78,
+  0x65, 0x63, 0x75, 0x74, 0x65, 0x2e, 0x20, 0x54, 0x68, 0x65, 0x20, 0x45,
+  0x64, 0x69, 0x74, 0x20, 0x63, 0x6f, 0x6d, 0x6d, 0x61, 0x6e, 0x64, 0x20,
+  0x6f, 0x70, 0x65, 0x6e, 0x73, 0x20, 0x74, 0x68, 0x65, 0x20, 0x6f, 0x75,
+  0x74, 0x70, 0x75, 0x74, 0x20, 0x69, 0x6e, 0x20, 0x61, 0x6e, 0x20, 0x65,
+  0x64, 0x69, 0x74, 0x6f, 0x72, 0x20, 0x77, 0x69, 0x6e, 0x64, 0x6f, 0x77,
+  0x20, 0x69, 0x6e, 0x73, 0x74, 0x65, 0x61, 0x64, 0x2c, 0x0a, 0x77, 0x68,
+  0x65, 0x72, 0x65, 0x20, 0x69, 0x74, 0x20, 0x63, 0x61, 0x6e, 0x20, 0x62,
+  0x65, 0x20, 0x73, 0x65, 0x61, 0x72, 0x63, 0x68, 0x65, 0x64, 0x20, 0x61,
+  0x6e, 0x64, 0x20, 0x73, 0x61, 0x76, 0x65, 0x64, 0x20, 0x6c, 0x69, 0x6b,
+  0x65, 0x20, 0x61, 0x6e, 0x79, 0x20, 0x66, 0x69, 0x6c, 0x65, 0x3b, 0x20,
+  0x74, 0x68, 0x65, 0x20, 0x65, 0x64, 0x69, 0x74, 0x6f, 0x72, 0x20, 0x6b,
+  0x65, 0x65, 0x70, 0x73, 0x20, 0x72, 0x65, 0x61, 0x64, 0x69, 0x6e, 0x67,
+  0x20, 0x66, 0x6f, 0x72, 0x0a, 0x61, 0x73, 0x20, 0x6c, 0x6f, 0x6e, 0x67,
+  0x20, 0x61, 0x73, 0x20, 0x74, 0x68, 0x65, 0x20, 0x63, 0x6f, 0x6d, 0x6d,
+  0x61, 0x6e, 0x64, 0x20, 0x6b, 0x65, 0x65, 0x70, 0x73, 0x20, 0x77, 0x72,
+  0x69, 0x74, 0x69, 0x6e, 0x67, 0x2e, 0x20, 0x47, 0x69, 0x76, 0x65, 0x20,
+  0x6f, 0x7a, 0x65, 0x74, 0x74, 0x65, 0x20, 0x22, 0x2d, 0x22, 0x20, 0x69,
+  0x6e, 0x20, 0x70, 0x6c, 0x61, 0x63, 0x65, 0x20, 0x6f, 0x66, 0x20, 0x61,
+  0x20, 0x66, 0x69, 0x6c, 0x65, 0x20, 0x6e, 0x61, 0x6d, 0x65, 0x0a, 0x74,
+  0x6f, 0x20, 0x65, 0x64, 0x69, 0x74, 0x20, 0x77, 0x68, 0x61, 0x74, 0x65,
+  0x76, 0x65, 0x72, 0x20, 0x69, 0x73, 0x20, 0x70, 0x69, 0x70, 0x65, 0x64,
+  0x20, 0x69, 0x6e, 0x74, 0x6f, 0x20, 0x69, 0x74, 0x20, 0x74, 0x68, 0x65,
+  0x20, 0x73, 0x61, 0x6d, 0x65, 0x20, 0x77, 0x61, 0x79, 0x2e, 0x0a, 0x0a,
   0x43, 0x6f, 0x6e, 0x73, 0x6f, 0x6c, 0x65, 0x20, 0x63, 0x6f, 0x6d, 0x6d,
   0x61, 0x6e, 0x64, 0x73, 0x3a, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5e, 0x4b,
   0x20, 0x2d, 0x20, 0x4b, 0x69, 0x6c, 0x6c, 0x20, 0x2d, 0x20, 0x74, 0x65,
   0x72, 0x6d, 0x69, 0x6e, 0x61, 0x74, 0x65, 0x20, 0x74, 0x68, 0x65, 0x20,
   0x72, 0x75, 0x6e, 0x6e, 0x69, 0x6e, 0x67, 0x20, 0x63, 0x6f, 0x6d, 0x6d,
-  0x61, 0x6e, 0x64, 0x0a, 0x0a
+  0x61, 0x6e, 0x64, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5e, 0x54, 0x20, 0x2d,
+  0x20, 0x45, 0x64, 0x69, 0x74, 0x20, 0x2d, 0x20, 0x6f, 0x70, 0x65, 0x6e,
+  0x20, 0x74, 0x68, 0x65, 0x20, 0x63, 0x6f, 0x6d, 0x6d, 0x61, 0x6e, 0x64,
+  0x27, 0x73, 0x20, 0x6f, 0x75, 0x74, 0x70, 0x75, 0x74, 0x20, 0x69, 0x6e,
+  0x20, 0x61, 0x6e, 0x20, 0x65, 0x64, 0x69, 0x74, 0x6f, 0x72, 0x20, 0x77,
+  0x69, 0x6e, 0x64, 0x6f, 0x77, 0x0a, 0x0a
 };
-unsigned int HELP_len = 3341;
+unsigned int HELP_len = 3739;
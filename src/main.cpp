@@ -16,9 +16,12 @@
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
 #include "app/ozette.h"
+#include <fcntl.h>
 #include <signal.h>
 #include <stdlib.h>
+#include <string.h>
 #include <locale.h>
+#include <unistd.h>
 
 static std::unique_ptr<Ozette> s_app;
 
@@ -36,9 +39,26 @@ int main(int argc, char **argv) {
 	(void)signal(SIGINT, handle_sigint);
 	(void)signal(SIGPIPE, SIG_IGN);
 	(void)signal(SIGIO, handle_sigio);
+	// Given "-", we will edit whatever is piped into our standard input. The
+	// terminal is where ncurses expects to find the keyboard, so we hang on
+	// to the pipe and put the terminal in its place.
+	int input = -1;
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "-") || isatty(STDIN_FILENO) || input >= 0) continue;
+		int tty = open("/dev/tty", O_RDONLY);
+		if (tty < 0) continue;
+		input = dup(STDIN_FILENO);
+		dup2(tty, STDIN_FILENO);
+		close(tty);
+	}
 	s_app.reset(new Ozette);
 	for (int i = 1; i < argc; ++i) {
-		s_app->edit_file(argv[i]);
+		if (strcmp(argv[i], "-")) {
+			s_app->edit_file(argv[i]);
+		} else if (input >= 0) {
+			s_app->edit_stream("stdin", input, "");
+			input = -1;
+		}
 	}
 	s_app->run();
 	return 0;
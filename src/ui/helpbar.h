@@ -56,6 +56,7 @@ struct Panel {
 	void directory() { label[1][2] = {"^D", "Directory"}; }
 	void build()     { label[1][4] = {"F5", "Build"}; }
 	void kill()      { label[0][0] = {"^K", "Kill"}; }
+	void edit()      { label[0][1] = {"^T", "Edit"}; }
 	void yes()       { label[0][0] = {" Y", "Yes"}; }
 	void no()        { label[0][1] = {" N", "No"}; }
 };
@@ -0,0 +1,50 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#ifndef TESTS_CHECK_H
+#define TESTS_CHECK_H
+
+#include <cstdio>
+
+// Each test program checks a series of claims about one part of the editor,
+// reporting every claim which turns out false, along with where it was made.
+// The program fails if any of them did, so make check can stop right there.
+namespace Check {
+inline int &failures() {
+	static int count = 0;
+	return count;
+}
+inline bool report(bool ok, const char *claim, const char *file, int line) {
+	if (!ok) {
+		fprintf(stderr, "%s:%d: check failed: %s\n", file, line, claim);
+		failures()++;
+	}
+	return ok;
+}
+inline int finish(const char *name) {
+	if (failures()) {
+		fprintf(stderr, "%s: %d failed\n", name, failures());
+		return 1;
+	}
+	printf("%s: ok\n", name);
+	return 0;
+}
+} // namespace Check
+
+#define CHECK(claim) Check::report((claim), #claim, __FILE__, __LINE__)
+
+#endif // TESTS_CHECK_H
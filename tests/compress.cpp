@@ -0,0 +1,106 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/compress.h"
+#include "check.h"
+#include <random>
+#include <string>
+
+namespace {
+bool round_trip(const std::string &text) {
+	std::string packed = Editor::compress(text.data(), text.size());
+	std::string out;
+	return Editor::decompress(packed.data(), packed.size(), text.size(), out) &&
+			out == text;
+}
+
+std::string source_like(std::mt19937 &rng, size_t size) {
+	// Lines made from a few patterns, the way code repeats itself.
+	static const char *lines[] = {
+		"\tfor (size_t i = 0; i < count; ++i) {\n",
+		"\t\tif (text[i] == '\\n') return i;\n",
+		"\t}\n",
+		"\treturn std::string(data, size);\n",
+		"\tsize_t count = text.size();\n",
+		"}\n\n",
+		"void Editor::Document::update(line_t index) {\n",
+		"\t// Nothing to see here.\n"
+	};
+	std::string out;
+	while (out.size() < size) out += lines[rng() % 8];
+	out.resize(size);
+	return out;
+}
+
+void test_round_trips() {
+	std::mt19937 rng(1);
+	CHECK(round_trip(""));
+	CHECK(round_trip("a"));
+	CHECK(round_trip("abcd"));
+	CHECK(round_trip("abcdabcdabcd"));
+	// Runs longer than the token can count need extra length bytes, and
+	// matches may overlap the text they copy.
+	CHECK(round_trip(std::string(100000, 'x')));
+	CHECK(round_trip("head" + std::string(300, 'y') + "tail"));
+	for (size_t size: {1, 3, 4, 5, 15, 16, 17, 255, 270, 4096, 65535, 65536,
+			70000, 1000000}) {
+		std::string noise;
+		for (size_t i = 0; i < size; ++i) noise.push_back(rng());
+		CHECK(round_trip(noise));
+		CHECK(round_trip(source_like(rng, size)));
+	}
+}
+
+void test_savings() {
+	// Source text should come out well under half its size.
+	std::mt19937 rng(2);
+	std::string text = source_like(rng, 1 << 20);
+	std::string packed = Editor::compress(text.data(), text.size());
+	CHECK(packed.size() < text.size() / 2);
+}
+
+void test_damage() {
+	// A block which doesn't come out to the expected size, or which ends
+	// partway through, must be rejected, not read past its end.
+	std::mt19937 rng(3);
+	std::string text = source_like(rng, 10000);
+	std::string packed = Editor::compress(text.data(), text.size());
+	std::string out;
+	CHECK(!Editor::decompress(packed.data(), packed.size(), text.size() + 1, out));
+	CHECK(!Editor::decompress(packed.data(), packed.size(), text.size() - 1, out));
+	for (size_t cut = 0; cut < packed.size(); cut += 7) {
+		out.clear();
+		if (!CHECK(!Editor::decompress(packed.data(), cut, text.size(), out))) {
+			break;
+		}
+	}
+	// Random garbage may or may not decode, but it must not crash.
+	for (int i = 0; i < 1000; ++i) {
+		std::string junk;
+		for (size_t k = rng() % 64; k > 0; --k) junk.push_back(rng());
+		out.clear();
+		Editor::decompress(junk.data(), junk.size(), rng() % 256, out);
+	}
+}
+} // namespace
+
+int main() {
+	test_round_trips();
+	test_savings();
+	test_damage();
+	return Check::finish("compress");
+}
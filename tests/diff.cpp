@@ -0,0 +1,155 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/diff.h"
+#include "check.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using Editor::Hunk;
+typedef std::vector<uint64_t> Lines;
+
+namespace {
+// Apply the hunks to the old version, which must yield the new one. Along
+// the way, make sure they come in order, without overlapping or touching,
+// and that each one really changes something.
+bool apply(const Lines &before, const Lines &after,
+		const std::vector<Hunk> &hunks, size_t &edits) {
+	Lines out;
+	size_t old_pos = 0;
+	size_t new_pos = 0;
+	edits = 0;
+	for (auto &h: hunks) {
+		if (h.old_begin > h.old_end || h.new_begin > h.new_end) return false;
+		if (h.old_begin == h.old_end && h.new_begin == h.new_end) return false;
+		if (h.old_begin < old_pos || h.old_end > before.size()) return false;
+		if (h.new_begin < new_pos || h.new_end > after.size()) return false;
+		if (old_pos && h.old_begin == old_pos && h.new_begin == new_pos) {
+			return false;
+		}
+		// The stretch between hunks must be the same in both versions.
+		if (h.old_begin - old_pos != h.new_begin - new_pos) return false;
+		out.insert(out.end(), before.begin() + old_pos, before.begin() + h.old_begin);
+		out.insert(out.end(), after.begin() + h.new_begin, after.begin() + h.new_end);
+		edits += (h.old_end - h.old_begin) + (h.new_end - h.new_begin);
+		old_pos = h.old_end;
+		new_pos = h.new_end;
+	}
+	out.insert(out.end(), before.begin() + old_pos, before.end());
+	return out == after;
+}
+
+size_t shortest(const Lines &a, const Lines &b) {
+	// The fewest lines to delete and insert, by way of the longest common
+	// subsequence, computed the slow and obvious way.
+	std::vector<std::vector<size_t>> lcs(
+			a.size() + 1, std::vector<size_t>(b.size() + 1, 0));
+	for (size_t i = a.size(); i-- > 0;) {
+		for (size_t j = b.size(); j-- > 0;) {
+			lcs[i][j] = a[i] == b[j]? lcs[i + 1][j + 1] + 1:
+					std::max(lcs[i + 1][j], lcs[i][j + 1]);
+		}
+	}
+	return a.size() + b.size() - 2 * lcs[0][0];
+}
+
+Lines random_lines(std::mt19937 &rng, size_t count, unsigned alphabet) {
+	Lines out;
+	for (size_t i = 0; i < count; ++i) out.push_back(rng() % alphabet);
+	return out;
+}
+
+void test_edges() {
+	size_t edits = 0;
+	Lines empty, some = {1, 2, 3};
+	CHECK(Editor::diff(empty, empty).empty());
+	CHECK(Editor::diff(some, some).empty());
+	auto added = Editor::diff(empty, some);
+	CHECK(added.size() == 1 && apply(empty, some, added, edits));
+	auto removed = Editor::diff(some, empty);
+	CHECK(removed.size() == 1 && apply(some, empty, removed, edits));
+	// One line changed in the middle makes one hunk of one line each way.
+	Lines changed = {1, 9, 3};
+	auto hunks = Editor::diff(some, changed);
+	CHECK(hunks.size() == 1);
+	CHECK(hunks[0].old_begin == 1 && hunks[0].old_end == 2);
+	CHECK(hunks[0].new_begin == 1 && hunks[0].new_end == 2);
+}
+
+void test_shortest() {
+	// Myers' algorithm finds an edit script as short as any, and the walk
+	// back through its trace must reproduce that script exactly.
+	std::mt19937 rng(1);
+	for (int round = 0; round < 2000; ++round) {
+		Lines a = random_lines(rng, rng() % 30, 2 + rng() % 6);
+		Lines b = random_lines(rng, rng() % 30, 2 + rng() % 6);
+		auto hunks = Editor::diff(a, b);
+		size_t edits = 0;
+		if (!CHECK(apply(a, b, hunks, edits))) return;
+		if (!CHECK(edits == shortest(a, b))) return;
+	}
+}
+
+void test_edited() {
+	// A long file with a few scattered edits keeps the rest in place.
+	std::mt19937 rng(2);
+	Lines before = random_lines(rng, 20000, 1u << 30);
+	Lines after = before;
+	for (int i = 0; i < 20; ++i) {
+		size_t at = rng() % after.size();
+		switch (i % 3) {
+			case 0: after[at] = rng(); break;
+			case 1: after.erase(after.begin() + at); break;
+			case 2: after.insert(after.begin() + at, rng()); break;
+		}
+	}
+	auto hunks = Editor::diff(before, after);
+	size_t edits = 0;
+	CHECK(apply(before, after, hunks, edits));
+	CHECK(edits <= 27);
+}
+
+void test_fallback() {
+	// Past the limit on differences, the diff gives up on the shortest
+	// script and replaces everything between the common ends at once.
+	std::mt19937 rng(3);
+	Lines head = random_lines(rng, 50, 1u << 30);
+	Lines tail = random_lines(rng, 50, 1u << 30);
+	Lines before = head, after = head;
+	for (int i = 0; i < 3000; ++i) {
+		before.push_back(rng());
+		after.push_back(rng());
+	}
+	before.insert(before.end(), tail.begin(), tail.end());
+	after.insert(after.end(), tail.begin(), tail.end());
+	auto hunks = Editor::diff(before, after);
+	size_t edits = 0;
+	CHECK(apply(before, after, hunks, edits));
+	CHECK(hunks.size() == 1);
+	CHECK(hunks[0].old_begin == 50 && hunks[0].old_end == 3050);
+	CHECK(hunks[0].new_begin == 50 && hunks[0].new_end == 3050);
+}
+} // namespace
+
+int main() {
+	test_edges();
+	test_shortest();
+	test_edited();
+	test_fallback();
+	return Check::finish("diff");
+}
@@ -0,0 +1,321 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#include "editor/document.h"
+#include "check.h"
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+
+using Editor::Config;
+using Editor::Document;
+using Editor::Update;
+using Editor::location_t;
+
+namespace {
+std::string s_dir;
+std::string s_path;
+
+void write_file(const std::string &path, const std::string &text) {
+	// Truncate and write over the file where it is, as some tools do.
+	int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	if (fd < 0) return;
+	ssize_t done = write(fd, text.data(), text.size());
+	(void)done;
+	close(fd);
+}
+
+void replace_file(const std::string &path, const std::string &text) {
+	// Write a new file and rename it into place, as many other tools do.
+	std::string temp = path + ".new";
+	write_file(temp, text);
+	rename(temp.c_str(), path.c_str());
+}
+
+std::string read_file(const std::string &path) {
+	std::string out;
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) return out;
+	char buf[65536];
+	ssize_t actual;
+	while ((actual = read(fd, buf, sizeof(buf))) > 0) out.append(buf, actual);
+	close(fd);
+	return out;
+}
+
+void load(Document &doc) {
+	while (doc.loading()) {
+		if (!doc.load_more()) usleep(1000);
+	}
+}
+
+std::string text(Document &doc) {
+	return doc.text(Editor::Range(doc.home(), doc.end())).str();
+}
+
+bool save(Document &doc, const std::string &path, const Config &config) {
+	std::string message;
+	doc.save(path, config);
+	return doc.collect_save(message);
+}
+
+std::string numbered(size_t count) {
+	// Big enough to be mapped, rather than copied.
+	std::string out;
+	for (size_t i = 0; i < count; ++i) {
+		out += "line " + std::to_string(i) + "\n";
+	}
+	return out;
+}
+
+void test_detach() {
+	// Once the document has been edited, a file rewritten in place, or cut
+	// short, changes nothing in it; saving writes the text we edited.
+	std::string original = numbered(200000);
+	write_file(s_path, original);
+	Document doc(s_path);
+	load(doc);
+	doc.insert(doc.home(), "x");
+	write_file(s_path, numbered(20));
+	CHECK(doc.line(0).str() == "xline 0");
+	CHECK(doc.line(150000).str() == "line 150000");
+	CHECK(text(doc) + "\n" == "x" + original);
+	CHECK(save(doc, s_path, Config()));
+	CHECK(read_file(s_path) == "x" + original);
+}
+
+void test_changed_mapping() {
+	// An unedited document whose file was rewritten in place has nothing
+	// left of the text it read, so it can't be saved, there or anywhere.
+	write_file(s_path, numbered(200000));
+	Document doc(s_path);
+	load(doc);
+	std::string replaced = numbered(200000);
+	replaced[0] = 'L';
+	write_file(s_path, replaced);
+	bool refused = false;
+	try {
+		doc.save(s_dir + "/elsewhere", Config());
+	} catch (std::runtime_error &) {
+		refused = true;
+	}
+	CHECK(refused);
+	CHECK(read_file(s_path) == replaced);
+}
+
+void test_rewritten() {
+	// Another program rewrites the file in place; the document follows, one
+	// undo brings back what we saved, and the history before that remains.
+	write_file(s_path, "alpha\nbeta\ngamma\n");
+	Document doc(s_path);
+	doc.insert(doc.home(1), "very ");
+	doc.commit();
+	CHECK(save(doc, s_path, Config()));
+	doc.refresh();
+	write_file(s_path, "alpha\nvery beta\nepsilon\n");
+	CHECK(doc.refresh());
+	CHECK(text(doc) == "alpha\nvery beta\nepsilon");
+	CHECK(!doc.modified());
+	Update update;
+	doc.undo(update);
+	CHECK(text(doc) == "alpha\nvery beta\ngamma");
+	doc.undo(update);
+	CHECK(text(doc) == "alpha\nbeta\ngamma");
+}
+
+void test_reprofiled() {
+	// The next save keeps the linebreaks the other program chose, and the
+	// final newline it left off.
+	write_file(s_path, "one\ntwo\n");
+	Document doc(s_path);
+	replace_file(s_path, "one\r\ntwo\r\nthree");
+	CHECK(doc.refresh());
+	doc.insert(doc.home(), "zero ");
+	CHECK(save(doc, s_path, Config()));
+	CHECK(read_file(s_path) == "zero one\r\ntwo\r\nthree");
+}
+
+void test_reread() {
+	// A mapped file rewritten in place left us nothing to compare, but the
+	// document still reads it again as an edit which can be undone.
+	write_file(s_path, numbered(200000));
+	Document doc(s_path);
+	load(doc);
+	std::string replaced = numbered(199999);
+	write_file(s_path, replaced);
+	CHECK(doc.refresh());
+	CHECK(text(doc) + "\n" == replaced);
+	CHECK(!doc.modified());
+	CHECK(doc.can_undo());
+	CHECK(save(doc, s_dir + "/elsewhere", Config()));
+	CHECK(read_file(s_dir + "/elsewhere") == replaced);
+}
+
+void test_back_to_saved() {
+	// Undoing every edit since the file was read, or last saved, leaves the
+	// document as it was, and it no longer counts as modified.
+	write_file(s_path, numbered(200000));
+	Document doc(s_path);
+	load(doc);
+	Update update;
+	doc.insert(doc.home(100000), "x");
+	doc.commit();
+	CHECK(doc.modified());
+	doc.undo(update);
+	CHECK(!doc.modified());
+	doc.redo(update);
+	CHECK(doc.modified());
+	CHECK(save(doc, s_path, Config()));
+	CHECK(!doc.modified());
+	doc.erase(Editor::Range(doc.home(5), doc.home(6)));
+	doc.commit();
+	CHECK(doc.modified());
+	doc.undo(update);
+	CHECK(!doc.modified());
+	doc.undo(update);
+	CHECK(doc.modified());
+}
+void test_charsets() {
+	// A file goes back out in the charset it came in, beginning with a byte
+	// order mark only if it had one.
+	struct {
+		std::string bytes;
+		std::string text;
+		Editor::Charset charset;
+	} cases[] = {
+		{"\xEF\xBB\xBF" "caf\xC3\xA9\n", "caf\xC3\xA9", Editor::Charset::UTF8BOM},
+		{std::string("\xFF\xFEh\0i\0\n\0", 8), "hi", Editor::Charset::UTF16LE},
+		{std::string("\xFE\xFF\0h\0i\0\n", 8), "hi", Editor::Charset::UTF16BE},
+		{std::string("h\0i\0\n\0", 6), "hi", Editor::Charset::UTF16LE},
+		{std::string("\0h\0i\0\n", 6), "hi", Editor::Charset::UTF16BE},
+		// Without a mark, bytes which aren't UTF-8 must be Latin-1.
+		{"caf\xE9\n", "caf\xC3\xA9", Editor::Charset::Latin1},
+		// A character cut off at the end of the sniffed window is still
+		// perfectly good UTF-8.
+		{std::string(4095, 'x') + "\xC3\xA9\n", std::string(4095, 'x') +
+				"\xC3\xA9", Editor::Charset::UTF8},
+	};
+	for (auto &c: cases) {
+		write_file(s_path, c.bytes);
+		Document doc(s_path);
+		load(doc);
+		CHECK(doc.charset() == c.charset);
+		CHECK(text(doc) == c.text);
+		CHECK(save(doc, s_path, Config()));
+		CHECK(read_file(s_path) == c.bytes);
+	}
+	// Without a mark, Latin-1 text is known only to the editorconfig.
+	std::string editorconfig = s_dir + "/.editorconfig";
+	write_file(editorconfig, "root = true\n[*]\ncharset = latin1\n");
+	write_file(s_path, "caf\xE9\n");
+	{
+		Document doc(s_path);
+		load(doc);
+		CHECK(doc.charset() == Editor::Charset::Latin1);
+		CHECK(text(doc) == "caf\xC3\xA9");
+		doc.insert(doc.end(), "!");
+		CHECK(save(doc, s_path, Config()));
+		CHECK(read_file(s_path) == "caf\xE9!\n");
+	}
+	unlink(editorconfig.c_str());
+}
+
+void test_replace_all() {
+	// Every match is replaced in one edit, which one undo takes back.
+	write_file(s_path, "foo bar foo\nfoofoo\nbaz\n");
+	Document doc(s_path);
+	load(doc);
+	Update update;
+	CHECK(doc.replace_all("foo", "x") == 4);
+	CHECK(text(doc) == "x bar x\nxx\nbaz");
+	doc.commit();
+	doc.undo(update);
+	CHECK(text(doc) == "foo bar foo\nfoofoo\nbaz");
+	CHECK(!doc.modified());
+	// The replacement is not searched again, so it may hold the needle.
+	CHECK(doc.replace_all("o", "oo") == 8);
+	CHECK(text(doc) == "foooo bar foooo\nfoooofoooo\nbaz");
+	// Nothing to find, or more than one line involved, changes nothing.
+	CHECK(doc.replace_all("", "x") == 0);
+	CHECK(doc.replace_all("quux", "x") == 0);
+	CHECK(doc.replace_all("o\nf", "x") == 0);
+	CHECK(doc.replace_all("bar", "\n") == 0);
+	CHECK(text(doc) == "foooo bar foooo\nfoooofoooo\nbaz");
+}
+void test_splice() {
+	// Many small edits go in together, as one edit for the undo history.
+	write_file(s_path, "alpha beta\ngamma\ndelta epsilon\n");
+	Document doc(s_path);
+	load(doc);
+	Update update;
+	doc.splice({
+		{0, 0, 5, Editor::Line("A")},
+		{0, 6, 10, Editor::Line("B")},
+		{1, 0, 0, Editor::Line(">")},
+		{2, 5, 13, Editor::Line("")},
+	});
+	CHECK(text(doc) == "A B\n>gamma\ndelta");
+	doc.commit();
+	doc.undo(update);
+	CHECK(text(doc) == "alpha beta\ngamma\ndelta epsilon");
+	CHECK(!doc.modified());
+	doc.redo(update);
+	CHECK(text(doc) == "A B\n>gamma\ndelta");
+	// Splicing every line of a mapped file, and undoing it, puts back
+	// exactly what the file held.
+	std::string original = numbered(200000);
+	write_file(s_path, original);
+	Document big(s_path);
+	load(big);
+	std::vector<Document::Splice> edits;
+	for (Editor::line_t i = 0; i < 200000; i += 3) {
+		edits.push_back({i, 0, 4, Editor::Line("LINE")});
+	}
+	big.splice(edits);
+	CHECK(big.line(3).str() == "LINE 3");
+	CHECK(big.line(4).str() == "line 4");
+	big.commit();
+	big.undo(update);
+	CHECK(text(big) + "\n" == original);
+	CHECK(!big.modified());
+}
+} // namespace
+
+int main() {
+	// Watchers and loaders raise SIGIO, which would otherwise end the program.
+	signal(SIGIO, SIG_IGN);
+	char dir[] = "/tmp/ozette-test-XXXXXX";
+	if (!mkdtemp(dir)) return 1;
+	s_dir = dir;
+	s_path = s_dir + "/file";
+	test_detach();
+	test_changed_mapping();
+	test_rewritten();
+	test_reprofiled();
+	test_reread();
+	test_back_to_saved();
+	test_charsets();
+	test_replace_all();
+	test_splice();
+	unlink(s_path.c_str());
+	unlink((s_dir + "/elsewhere").c_str());
+	rmdir(dir);
+	return Check::finish("document");
+}
@@ -0,0 +1,131 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/follower.h"
+#include "check.h"
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+using Editor::Follower;
+using Editor::Hash;
+using Editor::Line;
+
+namespace {
+std::string s_path;
+
+void write_file(const std::string &text) {
+	int fd = open(s_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	if (fd < 0) return;
+	ssize_t done = write(fd, text.data(), text.size());
+	(void)done;
+	close(fd);
+}
+
+void append_file(const std::string &text) {
+	int fd = open(s_path.c_str(), O_WRONLY | O_APPEND);
+	if (fd < 0) return;
+	ssize_t done = write(fd, text.data(), text.size());
+	(void)done;
+	close(fd);
+}
+
+std::vector<std::string> strings(const std::vector<Line> &lines) {
+	std::vector<std::string> out;
+	for (auto &line: lines) out.push_back(line.str());
+	return out;
+}
+
+void test_append() {
+	// The unfinished last line picks up where it left off, and a CRLF split
+	// across two writes is still one linebreak.
+	std::string text = "one\ntw";
+	write_file(text);
+	Follower follower(s_path, text.data(), text.size());
+	CHECK(follower.valid());
+	CHECK(follower.partial());
+	Hash hash;
+	hash.update(text.data(), text.size());
+	std::vector<Line> lines;
+	CHECK(!follower.read(lines, hash));
+	append_file("o\r");
+	text += "o\r";
+	CHECK(!follower.read(lines, hash));
+	append_file("\nthree\nfour\n");
+	text += "\nthree\nfour\n";
+	CHECK(follower.read(lines, hash));
+	CHECK((strings(lines) == std::vector<std::string>{"two", "three", "four"}));
+	CHECK(!follower.partial());
+	CHECK(hash.digest() == Hash::of(text.data(), text.size()));
+}
+
+void test_large() {
+	// More than one read's worth arrives at once.
+	write_file("");
+	Follower follower(s_path, "", 0);
+	std::string text;
+	std::vector<std::string> expect;
+	for (int i = 0; i < 50000; ++i) {
+		expect.push_back("line " + std::to_string(i));
+		text += expect.back() + "\n";
+	}
+	append_file(text);
+	Hash hash;
+	std::vector<Line> lines;
+	CHECK(follower.read(lines, hash));
+	CHECK(strings(lines) == expect);
+	CHECK(hash.digest() == Hash::of(text.data(), text.size()));
+	CHECK(!follower.truncated());
+}
+
+void test_truncated() {
+	// A file which shrinks has been rewritten, not appended to.
+	std::string text = "alpha\nbeta\n";
+	write_file(text);
+	Follower shrunk(s_path, text.data(), text.size());
+	write_file("alpha\n");
+	Hash hash;
+	std::vector<Line> lines;
+	CHECK(!shrunk.read(lines, hash));
+	CHECK(shrunk.truncated());
+	// So has one which grew, but no longer holds the text we read.
+	write_file(text);
+	Follower rewritten(s_path, text.data(), text.size());
+	write_file("gamma\ndelta\nmore\n");
+	CHECK(!rewritten.read(lines, hash));
+	CHECK(rewritten.truncated());
+	CHECK(lines.empty());
+	// Once truncated, a follower stays that way.
+	append_file("even more\n");
+	CHECK(!rewritten.read(lines, hash));
+}
+} // namespace
+
+int main() {
+	char path[] = "/tmp/ozette-test-XXXXXX";
+	int fd = mkstemp(path);
+	if (fd < 0) return 1;
+	close(fd);
+	s_path = path;
+	test_append();
+	test_large();
+	test_truncated();
+	unlink(path);
+	return Check::finish("follower");
+}
@@ -0,0 +1,339 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/journal.h"
+#include "editor/hash.h"
+#include "check.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <ftw.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using Editor::Change;
+using Editor::Journal;
+using Editor::location_t;
+using Editor::Range;
+
+namespace {
+std::string s_dir;
+
+Change random_change(std::mt19937 &rng) {
+	Change out;
+	out.erase = rng() % 2;
+	out.eraseloc = Range(location_t(rng() % 1000, rng() % 80),
+			location_t(rng() % 1000, rng() % 80));
+	if (out.erase) {
+		size_t size = rng() % 4? rng() % 40: rng() % 4000;
+		for (size_t i = 0; i < size; ++i) {
+			out.erasetext.push_back(rng() % 8? 'a' + rng() % 26: '\n');
+		}
+	}
+	out.insert = rng() % 2;
+	out.insertloc = Range(location_t(rng(), rng()), location_t(rng(), rng()));
+	out.split = rng() % 2;
+	out.splitloc = location_t(rng() % 1000, rng() % 80);
+	out.joined = rng() % 2;
+	return out;
+}
+
+bool same(const Range &a, const Range &b) {
+	return a.begin() == b.begin() && a.end() == b.end();
+}
+
+bool same(const Change &a, const Change &b) {
+	return a.erase == b.erase && same(a.eraseloc, b.eraseloc) &&
+			a.erasetext == b.erasetext && a.insert == b.insert &&
+			same(a.insertloc, b.insertloc) && a.split == b.split &&
+			a.splitloc == b.splitloc && a.joined == b.joined;
+}
+
+void test_round_trip() {
+	Journal::set_spill_dir("");
+	Journal::set_budget(32 * 1024 * 1024);
+	std::mt19937 rng(1);
+	Journal journal;
+	std::vector<Change> pushed;
+	for (int i = 0; i < 2000; ++i) {
+		pushed.push_back(random_change(rng));
+		journal.push(pushed.back());
+	}
+	CHECK(journal.count() == pushed.size());
+	while (!pushed.empty()) {
+		if (!CHECK(same(journal.pop(), pushed.back()))) return;
+		pushed.pop_back();
+	}
+	CHECK(journal.empty());
+}
+
+void test_growth() {
+	// Typing forward adds text at the end of the newest record, and
+	// backspacing adds it in front, backwards; either way, the text comes
+	// back out in document order.
+	Journal journal;
+	Change change;
+	change.erase = true;
+	change.erasetext = "cd";
+	journal.push(change);
+	journal.append("ef", 2, false);
+	journal.append("b", 1, true);
+	journal.append("a", 1, true);
+	journal.append(std::string(70000, 'g').data(), 70000, false);
+	Change top = journal.peek();
+	CHECK(top.erase && top.erasetext.empty());
+	top.insert = true;
+	top.insertloc = Range(location_t(1, 2), location_t(3, 4));
+	journal.amend(top);
+	Change out = journal.pop();
+	CHECK(out.erasetext == "abcdef" + std::string(70000, 'g'));
+	CHECK(out.insert && same(out.insertloc, top.insertloc));
+	CHECK(journal.empty());
+}
+
+void test_spill() {
+	// With a small budget, most of the records go out to the spill file,
+	// compressed, and must come back intact as the user undoes into them.
+	Journal::set_spill_dir(s_dir);
+	Journal::set_budget(64 * 1024);
+	std::mt19937 rng(2);
+	Journal journal;
+	std::vector<Change> pushed;
+	size_t peak = 0;
+	for (int i = 0; i < 5000; ++i) {
+		pushed.push_back(random_change(rng));
+		journal.push(pushed.back());
+		peak = std::max(peak, journal.resident());
+	}
+	CHECK(journal.count() == pushed.size());
+	CHECK(peak <= 64 * 1024 + 8192);
+	// Undo partway, push more, then undo all the way.
+	for (int i = 0; i < 1500; ++i) {
+		if (!CHECK(same(journal.pop(), pushed.back()))) return;
+		pushed.pop_back();
+	}
+	for (int i = 0; i < 500; ++i) {
+		pushed.push_back(random_change(rng));
+		journal.push(pushed.back());
+	}
+	while (!pushed.empty()) {
+		if (!CHECK(same(journal.pop(), pushed.back()))) return;
+		pushed.pop_back();
+	}
+	CHECK(journal.empty());
+}
+
+void test_forget() {
+	// Without anywhere to spill, the oldest records are dropped, but the
+	// newest still come back in order.
+	Journal::set_spill_dir("");
+	Journal::set_budget(64 * 1024);
+	std::mt19937 rng(3);
+	Journal journal;
+	std::vector<Change> pushed;
+	for (int i = 0; i < 5000; ++i) {
+		pushed.push_back(random_change(rng));
+		journal.push(pushed.back());
+	}
+	size_t kept = journal.count();
+	CHECK(kept > 0 && kept < pushed.size());
+	while (!journal.empty()) {
+		if (!CHECK(same(journal.pop(), pushed.back()))) return;
+		pushed.pop_back();
+	}
+	CHECK(pushed.size() == 5000 - kept);
+}
+
+void test_history() {
+	// A history saved with a file comes back when the file is opened with
+	// the same contents, and is thrown away when it isn't.
+	Journal::set_spill_dir(s_dir);
+	Journal::set_budget(64 * 1024);
+	std::mt19937 rng(4);
+	std::string file = s_dir + "/document.txt";
+	std::vector<Change> pushed;
+	{
+		Journal journal;
+		for (int i = 0; i < 3000; ++i) {
+			pushed.push_back(random_change(rng));
+			journal.push(pushed.back());
+		}
+		journal.preserve(file, 1, 2);
+	}
+	{
+		// Save again on top of the history we restored, while it is still
+		// mapped in, with a few more changes and a few undone.
+		Journal journal;
+		CHECK(journal.restore(file, 1, [] { return 2; }));
+		CHECK(journal.count() == pushed.size());
+		for (int i = 0; i < 100; ++i) {
+			if (!CHECK(same(journal.pop(), pushed.back()))) return;
+			pushed.pop_back();
+		}
+		for (int i = 0; i < 200; ++i) {
+			pushed.push_back(random_change(rng));
+			journal.push(pushed.back());
+		}
+		journal.preserve(file, 3, 4);
+		for (int i = 0; i < 50; ++i) {
+			if (!CHECK(same(journal.pop(), pushed[pushed.size() - 1 - i]))) {
+				return;
+			}
+		}
+	}
+	{
+		Journal journal;
+		CHECK(!journal.restore(file, 1, [] { return 2; }));
+	}
+	{
+		// That failure deleted the history, so nothing comes back now.
+		Journal journal;
+		CHECK(!journal.restore(file, 3, [] { return 4; }));
+	}
+	{
+		Journal journal;
+		for (auto &change: pushed) journal.push(change);
+		journal.preserve(file, 5, 6);
+	}
+	{
+		// The lines must match too, not just the file's contents.
+		Journal journal;
+		CHECK(!journal.restore(file, 5, [] { return 7; }));
+	}
+	{
+		Journal journal;
+		for (auto &change: pushed) journal.push(change);
+		journal.preserve(file, 5, 6);
+	}
+	Journal journal;
+	CHECK(journal.restore(file, 5, [] { return 6; }));
+	CHECK(journal.count() == pushed.size());
+	while (!pushed.empty()) {
+		if (!CHECK(same(journal.pop(), pushed.back()))) return;
+		pushed.pop_back();
+	}
+	CHECK(journal.empty());
+}
+
+std::string history_file(const std::string &file) {
+	char name[17];
+	uint64_t key = Editor::Hash::of(file.data(), file.size());
+	snprintf(name, sizeof(name), "%016llx", (unsigned long long)key);
+	return s_dir + "/history/" + name;
+}
+
+void test_incremental() {
+	// Saving again adds the new records to the history file already there,
+	// rather than writing it all out anew.
+	Journal::set_spill_dir(s_dir);
+	Journal::set_budget(64 * 1024);
+	std::mt19937 rng(5);
+	std::string file = s_dir + "/incremental.txt";
+	std::vector<Change> pushed;
+	Journal journal;
+	for (int i = 0; i < 2000; ++i) {
+		pushed.push_back(random_change(rng));
+		journal.push(pushed.back());
+	}
+	journal.preserve(file, 1, 2);
+	std::string path = history_file(file);
+	struct stat before;
+	CHECK(0 == stat(path.c_str(), &before));
+	for (int i = 0; i < 10; ++i) {
+		pushed.push_back(random_change(rng));
+		journal.push(pushed.back());
+	}
+	journal.preserve(file, 3, 4);
+	struct stat after;
+	CHECK(0 == stat(path.c_str(), &after));
+	CHECK(after.st_ino == before.st_ino);
+	CHECK(after.st_size > before.st_size);
+	Journal restored;
+	CHECK(restored.restore(file, 3, [] { return 4; }));
+	CHECK(restored.count() == pushed.size());
+	while (!pushed.empty()) {
+		if (!CHECK(same(restored.pop(), pushed.back()))) return;
+		pushed.pop_back();
+	}
+}
+
+void test_damaged() {
+	// A history file with bytes scribbled over it is either refused, or
+	// every record in it can be undone without reading outside the file.
+	Journal::set_spill_dir(s_dir);
+	Journal::set_budget(32 * 1024 * 1024);
+	std::mt19937 rng(6);
+	std::string file = s_dir + "/damaged.txt";
+	Journal journal;
+	for (int i = 0; i < 50; ++i) {
+		journal.push(random_change(rng));
+	}
+	journal.preserve(file, 1, 2);
+	std::string path = history_file(file);
+	std::string good;
+	FILE *fp = fopen(path.c_str(), "rb");
+	if (!CHECK(fp != nullptr)) return;
+	char buf[4096];
+	size_t got;
+	while ((got = fread(buf, 1, sizeof(buf), fp)) > 0) good.append(buf, got);
+	fclose(fp);
+	size_t refused = 0;
+	for (int i = 0; i < 500; ++i) {
+		std::string bad = good;
+		// Leave the identifying header alone, or every copy is refused
+		// before the records are ever looked at.
+		size_t header = 40;
+		for (int j = 0; j < 4; ++j) {
+			bad[header + rng() % (bad.size() - header)] = rng();
+		}
+		fp = fopen(path.c_str(), "wb");
+		if (!CHECK(fp != nullptr)) return;
+		fwrite(bad.data(), 1, bad.size(), fp);
+		fclose(fp);
+		Journal restored;
+		if (!restored.restore(file, 1, [] { return 2; })) {
+			CHECK(0 != access(path.c_str(), F_OK));
+			refused++;
+			continue;
+		}
+		while (restored.count()) restored.pop();
+	}
+	CHECK(refused > 0);
+}
+
+int remove_entry(const char *path, const struct stat*, int, struct FTW*) {
+	return remove(path);
+}
+} // namespace
+
+int main() {
+	char dir[] = "/tmp/ozette-test-XXXXXX";
+	if (!mkdtemp(dir)) return 1;
+	s_dir = dir;
+	test_round_trip();
+	test_growth();
+	test_spill();
+	test_forget();
+	test_history();
+	test_incremental();
+	test_damaged();
+	nftw(dir, remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+	return Check::finish("journal");
+}
@@ -0,0 +1,172 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/linetree.h"
+#include "check.h"
+#include <random>
+#include <string>
+#include <vector>
+
+using Editor::Line;
+using Editor::LineTree;
+
+namespace {
+// Random edits go to the tree and to a plain vector of strings alike; the
+// tree must always hold exactly what the vector does.
+typedef std::vector<std::string> Model;
+
+bool same(const LineTree &tree, const Model &model) {
+	if (tree.size() != model.size()) return false;
+	size_t i = 0;
+	for (auto &line: tree) {
+		if (line.str() != model[i++]) return false;
+	}
+	for (i = 0; i < model.size(); ++i) {
+		if (tree[i].str() != model[i]) return false;
+	}
+	return true;
+}
+
+std::string text(std::mt19937 &rng) {
+	// Mostly short lines, which live inside the line object, and some long
+	// enough to need storage of their own.
+	size_t size = rng() % 4? rng() % 20: 20 + rng() % 60;
+	std::string out;
+	for (size_t i = 0; i < size; ++i) out.push_back('a' + rng() % 26);
+	return out;
+}
+
+void edit(LineTree &tree, Model &model, std::mt19937 &rng) {
+	size_t at = rng() % (model.size() + 1);
+	switch (rng() % 5) {
+		case 0: {
+			std::string line = text(rng);
+			tree.insert(at, Line(line));
+			model.insert(model.begin() + at, line);
+		} break;
+		case 1: {
+			// A bulk insert, big enough to fill several leaves.
+			std::vector<Line> lines;
+			Model added;
+			size_t count = rng() % 300;
+			for (size_t i = 0; i < count; ++i) {
+				added.push_back(text(rng));
+				lines.emplace_back(added.back());
+			}
+			tree.insert(at, std::move(lines));
+			model.insert(model.begin() + at, added.begin(), added.end());
+		} break;
+		case 2: {
+			size_t end = at + rng() % (model.size() - at + 1);
+			tree.erase(at, end);
+			model.erase(model.begin() + at, model.begin() + end);
+		} break;
+		default: {
+			if (at == model.size()) break;
+			std::string line = text(rng);
+			tree.set(at, Line(line));
+			model[at] = line;
+		} break;
+	}
+}
+
+void test_edits() {
+	std::mt19937 rng(1);
+	for (int round = 0; round < 20; ++round) {
+		LineTree tree;
+		Model model;
+		for (int i = 0; i < 500; ++i) {
+			edit(tree, model, rng);
+			if (!CHECK(same(tree, model))) return;
+		}
+		tree.clear();
+		CHECK(tree.empty());
+	}
+}
+
+void test_iterator() {
+	// Starting partway through should visit the rest in order.
+	LineTree tree;
+	Model model;
+	for (int i = 0; i < 5000; ++i) {
+		model.push_back(std::to_string(i));
+		tree.push_back(Line(model.back()));
+	}
+	size_t index = 1234;
+	for (auto iter = tree.at(index); iter != tree.end(); ++iter) {
+		if (!CHECK(iter->str() == model[index++])) return;
+	}
+	CHECK(index == model.size());
+}
+
+void test_copies() {
+	// An edit to a copy leaves the original, and its digest, alone.
+	std::mt19937 rng(2);
+	LineTree tree;
+	Model model;
+	for (int i = 0; i < 50; ++i) edit(tree, model, rng);
+	uint64_t digest = tree.digest();
+	for (int i = 0; i < 50; ++i) {
+		LineTree copy = tree;
+		Model copied = model;
+		edit(copy, copied, rng);
+		CHECK(same(copy, copied));
+		CHECK(same(tree, model));
+		CHECK(tree.digest() == digest);
+	}
+}
+
+void test_digest() {
+	// The digest depends on the text alone, not on the shape of the tree
+	// or the order of the edits which built it.
+	std::mt19937 rng(3);
+	for (int round = 0; round < 20; ++round) {
+		LineTree tree;
+		Model model;
+		for (int i = 0; i < 200; ++i) edit(tree, model, rng);
+		uint64_t before = tree.digest();
+		LineTree fresh;
+		std::vector<Line> lines;
+		for (auto &text: model) lines.emplace_back(text);
+		fresh.insert(0, std::move(lines));
+		CHECK(fresh.digest() == before);
+		// Changing any one line must change the digest, and changing it
+		// back must restore it.
+		if (model.empty()) continue;
+		size_t at = rng() % model.size();
+		tree.set(at, Line(model[at] + "!"));
+		CHECK(tree.digest() != before);
+		tree.set(at, Line(model[at]));
+		CHECK(tree.digest() == before);
+	}
+	// Moving a linebreak must change the digest too.
+	LineTree a, b;
+	a.push_back(Line("ab"));
+	a.push_back(Line("c"));
+	b.push_back(Line("a"));
+	b.push_back(Line("bc"));
+	CHECK(a.digest() != b.digest());
+}
+} // namespace
+
+int main() {
+	test_edits();
+	test_iterator();
+	test_copies();
+	test_digest();
+	return Check::finish("linetree");
+}
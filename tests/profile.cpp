@@ -0,0 +1,100 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/profile.h"
+#include "check.h"
+#include <random>
+#include <string>
+#include <vector>
+
+using Editor::Line;
+using Editor::Profile;
+
+namespace {
+Profile profile(const std::vector<std::string> &lines,
+		Profile::EOL ending = Profile::EOL::LF) {
+	Profile out;
+	for (auto &text: lines) out.line(Line(text), ending);
+	return out;
+}
+
+void test_endings() {
+	Profile p;
+	p.line(Line("a"), Profile::EOL::LF);
+	CHECK(p.eol() == Profile::EOL::LF);
+	p.line(Line("b"), Profile::EOL::CRLF);
+	p.line(Line("c"), Profile::EOL::CRLF);
+	CHECK(p.eol() == Profile::EOL::Mixed);
+	CHECK(p.lf == 1 && p.crlf == 2);
+	p.line(Line("d"), Profile::EOL::None);
+	CHECK(p.lines == 4);
+	CHECK(p.last == Profile::EOL::None);
+	CHECK(Profile().eol() == Profile::EOL::None);
+	CHECK(profile({"x"}, Profile::EOL::CRLF).eol() == Profile::EOL::CRLF);
+}
+
+void test_text() {
+	Profile p = profile({"plain", std::string(300, 'x')});
+	p.line(Line("caf\xC3\xA9"), Profile::EOL::LF);
+	CHECK(p.invalid == 0);
+	p.line(Line("caf\xE9"), Profile::EOL::LF);
+	p.line(Line("\xC3"), Profile::EOL::LF);
+	CHECK(p.invalid == 2);
+}
+
+void test_merge() {
+	// The loader profiles a big file a chunk at a time and merges the
+	// results, which must come out just as if it had profiled the file in
+	// one pass, wherever the seams fall.
+	std::mt19937 rng(1);
+	const Profile::EOL kinds[] = {
+		Profile::EOL::LF, Profile::EOL::CRLF, Profile::EOL::None
+	};
+	for (int round = 0; round < 2000; ++round) {
+		std::vector<std::string> lines;
+		std::vector<Profile::EOL> endings;
+		for (int i = 1 + rng() % 40; i > 0; --i) {
+			lines.push_back(rng() % 8? "x": "caf\xE9");
+			endings.push_back(kinds[rng() % 3]);
+		}
+		Profile whole;
+		for (size_t i = 0; i < lines.size(); ++i) {
+			whole.line(Line(lines[i]), endings[i]);
+		}
+		Profile merged;
+		size_t i = 0;
+		while (i < lines.size()) {
+			Profile chunk;
+			for (size_t end = i + 1 + rng() % 6; i < end && i < lines.size(); ++i) {
+				chunk.line(Line(lines[i]), endings[i]);
+			}
+			merged.merge(chunk);
+		}
+		bool same = whole.lines == merged.lines && whole.lf == merged.lf &&
+				whole.crlf == merged.crlf && whole.last == merged.last &&
+				whole.invalid == merged.invalid;
+		if (!CHECK(same)) return;
+	}
+}
+} // namespace
+
+int main() {
+	test_endings();
+	test_text();
+	test_merge();
+	return Check::finish("profile");
+}
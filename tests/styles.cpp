@@ -0,0 +1,109 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/styles.h"
+#include "ui/colors.h"
+#include "check.h"
+#include <random>
+#include <string>
+#include <vector>
+
+using Editor::Delta;
+using Editor::Line;
+using Editor::Styles;
+
+namespace {
+const Syntax::Grammar kDigits = {
+	Syntax::Rule("[0-9]+", Syntax::Token::Type::Literal)
+};
+
+bool same(const std::vector<Styles::Run> &a, const std::vector<Styles::Run> &b) {
+	if (a.size() != b.size()) return false;
+	for (size_t i = 0; i < a.size(); ++i) {
+		if (a[i].end != b[i].end || a[i].style != b[i].style) return false;
+	}
+	return true;
+}
+
+Delta delta(Delta::Kind kind, Editor::line_t index, size_t removed, size_t added) {
+	return Delta{kind, 0, index, removed, added};
+}
+
+void test_runs() {
+	// Each run reaches to the end of the characters sharing its style, and
+	// trailing whitespace stands out as an error.
+	Styles styles(kDigits);
+	auto &runs = styles.runs(0, Line("ab 12 "));
+	CHECK(same(runs, {
+		{3, 0},
+		{5, UI::Colors::literal()},
+		{6, UI::Colors::error()},
+	}));
+	CHECK(styles.runs(1, Line()).empty());
+}
+
+void test_moved() {
+	// Lines after a change keep the runs we found for them, under their new
+	// index; the lines it replaced must be styled again.
+	Styles styles(kDigits);
+	std::string text(40, 'x');
+	Line before(text + "1"), after(text + "2");
+	const Styles::Run *kept = styles.runs(5, after).data();
+	styles.runs(2, before);
+	styles.changed(delta(Delta::Kind::Split, 2, 1, 2));
+	CHECK(styles.runs(6, after).data() == kept);
+	Line replaced(text + "3");
+	CHECK(styles.runs(2, replaced).size() == 2);
+}
+
+void test_edits() {
+	// However the document changes, the runs must match those of a line
+	// styled from scratch.
+	std::mt19937 rng(1);
+	std::vector<Line> lines;
+	Styles cached(kDigits);
+	for (int round = 0; round < 5000; ++round) {
+		size_t at = rng() % (lines.size() + 1);
+		std::string text(rng() % 30, 'a');
+		for (auto &ch: text) if (rng() % 4 == 0) ch = '0' + rng() % 10;
+		if (rng() % 3 == 0) text += "  ";
+		if (at == lines.size() || rng() % 2) {
+			lines.insert(lines.begin() + at, Line(text));
+			cached.changed(delta(Delta::Kind::Insert, at, 0, 1));
+		} else if (rng() % 2) {
+			lines.erase(lines.begin() + at);
+			cached.changed(delta(Delta::Kind::Erase, at, 1, 0));
+		} else {
+			lines[at] = Line(text);
+			cached.changed(delta(Delta::Kind::Insert, at, 1, 1));
+		}
+		for (int i = 0; i < 4 && !lines.empty(); ++i) {
+			size_t index = rng() % lines.size();
+			Styles fresh(kDigits);
+			auto &expect = fresh.runs(index, lines[index]);
+			if (!CHECK(same(cached.runs(index, lines[index]), expect))) return;
+		}
+	}
+}
+} // namespace
+
+int main() {
+	test_runs();
+	test_moved();
+	test_edits();
+	return Check::finish("styles");
+}
@@ -0,0 +1,104 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/document.h"
+#include "editor/text.h"
+#include "check.h"
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+
+using Editor::Line;
+using Editor::Text;
+using Editor::location_t;
+
+namespace {
+std::string flatten(const Text &text) {
+	std::string out;
+	for (auto piece: text) out.append(piece.data, piece.size);
+	return out;
+}
+
+void test_pieces() {
+	// A text begins partway through its first line and ends partway through
+	// its last; the lines between belong to it whole, and are shared.
+	std::string middle(100, 'm');
+	std::vector<Line> lines = {Line("first"), Line(middle), Line("last")};
+	Line shared = lines[1];
+	Text text(lines, 2, 3, nullptr);
+	CHECK(text.str() == "rst\n" + middle + "\nlas");
+	CHECK(flatten(text) == text.str());
+	CHECK(text.size() == text.str().size());
+	CHECK(text.lines() == 3);
+	CHECK(text.share(1).same(shared));
+	CHECK(text.share(0).str() == "rst");
+	// Ends beyond their lines are pulled back in.
+	Text clamped(lines, 99, 99, nullptr);
+	CHECK(clamped.str() == "\n" + middle + "\nlast");
+	CHECK(Text().empty() && Text().lines() == 1);
+}
+
+void test_concat() {
+	Text joined = Text("ab\nc") + Text("d\ne");
+	CHECK(joined.str() == "ab\ncd\ne");
+	CHECK(joined.lines() == 3);
+	CHECK((Text() + Text("x")).str() == "x");
+	CHECK((Text("x\n") + Text()).str() == "x\n");
+}
+
+void test_document() {
+	// A text taken from a mapped file outlives the document it came from,
+	// and can go into another document whole.
+	char dir[] = "/tmp/ozette-test-XXXXXX";
+	if (!mkdtemp(dir)) return;
+	std::string path = std::string(dir) + "/file";
+	std::string content;
+	for (size_t i = 0; i < 200000; ++i) {
+		content += "line " + std::to_string(i) + "\n";
+	}
+	int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	ssize_t done = write(fd, content.data(), content.size());
+	(void)done;
+	close(fd);
+	Text text;
+	{
+		Editor::Document doc(path);
+		while (doc.loading()) {
+			if (!doc.load_more()) usleep(1000);
+		}
+		text = doc.text(Editor::Range(location_t(10, 2), location_t(12, 4)));
+	}
+	unlink(path.c_str());
+	CHECK(text.str() == "ne 10\nline 11\nline");
+	Editor::Document other;
+	other.insert(location_t(0, 0), text);
+	CHECK(other.text(Editor::Range(other.home(), other.end())).str() ==
+			text.str());
+	rmdir(dir);
+}
+} // namespace
+
+int main() {
+	// Watchers and loaders raise SIGIO, which would otherwise end the program.
+	signal(SIGIO, SIG_IGN);
+	test_pieces();
+	test_concat();
+	test_document();
+	return Check::finish("text");
+}
@@ -0,0 +1,101 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#include "editor/watcher.h"
+#include "check.h"
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+
+using Editor::Watcher;
+
+namespace {
+std::string s_dir;
+
+std::string path_of(int i) {
+	return s_dir + "/file" + std::to_string(i);
+}
+
+void write_file(const std::string &path, const std::string &text) {
+	int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	if (fd < 0) return;
+	ssize_t done = write(fd, text.data(), text.size());
+	(void)done;
+	close(fd);
+}
+
+void test_many() {
+	// There are only 128 inotify instances to go around, by default, so a
+	// watcher apiece for this many files would run out.
+	const int count = 300;
+	std::vector<std::unique_ptr<Watcher>> watchers;
+	for (int i = 0; i < count; ++i) {
+		write_file(path_of(i), "text\n");
+		watchers.emplace_back(new Watcher(path_of(i)));
+		CHECK(watchers.back()->valid());
+	}
+	for (auto &watcher: watchers) watcher->changed();
+	// Each hears about its own file, and none of the others.
+	write_file(path_of(7), "more text\n");
+	write_file(path_of(250), "more text\n");
+	for (int i = 0; i < count; ++i) {
+		bool expect = i == 7 || i == 250;
+		CHECK(watchers[i]->changed() == expect);
+	}
+	for (int i = 0; i < count; ++i) unlink(path_of(i).c_str());
+}
+
+void test_shared() {
+	// Two watchers on the same file share its watch; when one goes, the
+	// other goes on hearing about the file.
+	std::string path = path_of(0);
+	write_file(path, "one\n");
+	std::unique_ptr<Watcher> first(new Watcher(path));
+	Watcher second(path);
+	write_file(path, "two\n");
+	CHECK(first->changed());
+	CHECK(second.changed());
+	first.reset();
+	write_file(path, "three\n");
+	CHECK(second.changed());
+	CHECK(!second.changed());
+	// A file renamed into place is the one to watch from then on.
+	std::string temp = path_of(1);
+	write_file(temp, "four\n");
+	second.changed();
+	CHECK(0 == rename(temp.c_str(), path.c_str()));
+	CHECK(second.changed());
+	write_file(path, "five\n");
+	CHECK(second.changed());
+	unlink(path.c_str());
+}
+} // namespace
+
+int main() {
+	// Events arrive by SIGIO, which would otherwise end the program.
+	signal(SIGIO, SIG_IGN);
+	char dir[] = "/tmp/ozette-test-XXXXXX";
+	if (!mkdtemp(dir)) return 1;
+	s_dir = dir;
+	test_many();
+	test_shared();
+	rmdir(dir);
+	return Check::finish("watcher");
+}
@@ -0,0 +1,134 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "editor/writer.h"
+#include "check.h"
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using Editor::Config;
+using Editor::Line;
+using Editor::LineTree;
+
+namespace {
+std::string s_dir;
+std::string s_path;
+
+LineTree lines(std::vector<std::string> text) {
+	LineTree out;
+	for (auto &line: text) out.push_back(Line(line));
+	return out;
+}
+
+std::string read_file(const std::string &path) {
+	std::string out;
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) return out;
+	char buf[65536];
+	ssize_t actual;
+	while ((actual = read(fd, buf, sizeof(buf))) > 0) out.append(buf, actual);
+	close(fd);
+	return out;
+}
+
+std::string written(std::vector<std::string> text, const Config &config) {
+	Editor::write(lines(text), s_path, config);
+	return read_file(s_path);
+}
+
+void test_format() {
+	// The config decides how lines end, whether the last one does, and
+	// whether trailing whitespace survives.
+	Config config;
+	CHECK(written({"a", "b"}, config) == "a\nb");
+	config.set_insert_final_newline(true);
+	CHECK(written({"a", "b"}, config) == "a\nb\n");
+	config.set_end_of_line("crlf");
+	CHECK(written({"a", "b"}, config) == "a\r\nb\r\n");
+	config.set_end_of_line("cr");
+	CHECK(written({"a", "b"}, config) == "a\rb\r");
+	CHECK(written({}, config) == "");
+	// Nothing asks for trimming but an editorconfig file.
+	std::string editorconfig = s_dir + "/.editorconfig";
+	int fd = open(editorconfig.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	std::string rules = "root = true\n[*]\ntrim_trailing_whitespace = true\n";
+	ssize_t done = write(fd, rules.data(), rules.size());
+	(void)done;
+	close(fd);
+	Config trim;
+	trim.load(s_path);
+	CHECK(written({"a \t", "  ", " b "}, trim) == "a\n\n b");
+	unlink(editorconfig.c_str());
+	CHECK(written({"a \t", " b "}, Config()) == "a \t\n b ");
+}
+
+void test_charset() {
+	// A line the charset has no room for fails the save, leaving the old
+	// file as it was.
+	Config config;
+	config.set_charset(Editor::Charset::Latin1);
+	CHECK(written({"caf\xC3\xA9"}, config) == "caf\xE9");
+	bool refused = false;
+	try {
+		written({"\xE2\x82\xAC"}, config);
+	} catch (std::runtime_error &) {
+		refused = true;
+	}
+	CHECK(refused);
+	CHECK(read_file(s_path) == "caf\xE9");
+	config.set_charset(Editor::Charset::UTF16LE);
+	CHECK(written({"hi"}, config) == std::string("\xFF\xFEh\0i\0", 6));
+	config.set_byte_order_mark(false);
+	CHECK(written({"hi"}, config) == std::string("h\0i\0", 4));
+}
+
+void test_replace() {
+	// The new file takes the place of the old, with its mode and owner, and
+	// without waiting for the disk when asked not to.
+	written({"old"}, Config());
+	chmod(s_path.c_str(), 0640);
+	bool root = 0 == geteuid();
+	if (root && chown(s_path.c_str(), 1234, 5678)) root = false;
+	Editor::set_sync(false);
+	CHECK(written({"new"}, Config()) == "new");
+	Editor::set_sync(true);
+	struct stat sb;
+	CHECK(0 == stat(s_path.c_str(), &sb));
+	CHECK((sb.st_mode & 07777) == 0640);
+	if (root) {
+		CHECK(sb.st_uid == 1234);
+		CHECK(sb.st_gid == 5678);
+	}
+}
+} // namespace
+
+int main() {
+	char dir[] = "/tmp/ozette-test-XXXXXX";
+	if (!mkdtemp(dir)) return 1;
+	s_dir = dir;
+	s_path = s_dir + "/file";
+	test_format();
+	test_charset();
+	test_replace();
+	unlink(s_path.c_str());
+	rmdir(dir);
+	return Check::finish("writer");
+}
@@ -0,0 +1,122 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+// Measure the linebreak scan behind LineIndex. The scanners live in an
+// anonymous namespace, so we pull in the whole source file in order to time
+// each one separately against a plain memchr loop, and against reading lines
+// with std::getline the way most programs do, over text with short, typical,
+// and long lines.
+#include "../src/editor/lineindex.cpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <istream>
+#include <streambuf>
+#include <string>
+
+namespace {
+const size_t kSize = 128 * 1024 * 1024;
+const int kRounds = 5;
+
+std::string make_text(size_t line_length) {
+	// Vary the lengths a little, so the branches can't simply learn them.
+	std::string text;
+	text.reserve(kSize + line_length * 2);
+	srand(1);
+	while (text.size() < kSize) {
+		size_t length = line_length / 2 + rand() % (line_length + 1);
+		text.append(length, 'x');
+		text.push_back('\n');
+	}
+	return text;
+}
+
+// Lets an istream read straight out of the text, so getline pays for its
+// own work and not for a copy of the buffer.
+struct MemoryBuf : std::streambuf {
+	MemoryBuf(const char *data, size_t size) {
+		char *begin = const_cast<char*>(data);
+		setg(begin, begin, begin + size);
+	}
+};
+
+template <typename Scan>
+void measure(const char *label, const std::string &text, size_t expect, Scan scan) {
+	// Report the best of several rounds, along with a count of the breaks,
+	// which must agree with every other scanner's.
+	double best = 0;
+	size_t found = 0;
+	for (int i = 0; i < kRounds; ++i) {
+		std::vector<uint32_t> out;
+		out.reserve(text.size() / 32);
+		auto start = std::chrono::steady_clock::now();
+		scan(text.data(), text.size(), out);
+		auto stop = std::chrono::steady_clock::now();
+		double secs = std::chrono::duration<double>(stop - start).count();
+		if (i == 0 || secs < best) best = secs;
+		found = out.size();
+	}
+	double rate = text.size() / best / (1024 * 1024);
+	printf("  %-10s %8.0f MB/s%s\n", label, rate, found == expect? "": "  WRONG");
+}
+} // namespace
+
+int main() {
+	for (size_t length: {8, 40, 200}) {
+		std::string text = make_text(length);
+		std::vector<uint32_t> baseline;
+		scan_scalar(text.data(), 0, text.size(), baseline);
+		size_t expect = baseline.size();
+		printf("lines of about %zu bytes, %zu lines:\n", length, expect);
+		measure("getline", text, expect,
+				[](const char *data, size_t size, std::vector<uint32_t> &out) {
+			MemoryBuf buf(data, size);
+			std::istream in(&buf);
+			std::string line;
+			size_t pos = 0;
+			while (std::getline(in, line)) {
+				pos += line.size();
+				if (!in.eof()) out.push_back(pos++);
+			}
+		});
+		measure("memchr", text, expect,
+				[](const char *data, size_t size, std::vector<uint32_t> &out) {
+			scan_scalar(data, 0, size, out);
+		});
+#if defined(__SSE2__)
+		measure("sse2", text, expect,
+				[](const char *data, size_t size, std::vector<uint32_t> &out) {
+			bool nul = false;
+			scan_scalar(data, scan_sse2(data, size, out, nul), size, out);
+		});
+		if (__builtin_cpu_supports("avx2")) {
+			measure("avx2", text, expect,
+					[](const char *data, size_t size, std::vector<uint32_t> &out) {
+				bool nul = false;
+				scan_scalar(data, scan_avx2(data, size, out, nul), size, out);
+			});
+		}
+#endif
+		measure("LineIndex", text, expect,
+				[](const char *data, size_t size, std::vector<uint32_t> &out) {
+			Editor::LineIndex index;
+			index.scan(data, size);
+			out.resize(index.size());
+		});
+	}
+	return 0;
+}
@@ -0,0 +1,91 @@
+// ozette
+// Copyright (C) 2025 Mars J. Saxman
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+// Measure the charset transcoders on plain ASCII text, where the vector
+// paths carry most of the load, and on text mixed with accented letters,
+// where they keep dropping back to scalar code.
+#include "editor/charset.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+const size_t kSize = 64 * 1024 * 1024;
+const int kRounds = 5;
+
+std::string make_text(bool mixed) {
+	// UTF-8 lines of words, with one letter in eight accented if mixed.
+	std::string text;
+	text.reserve(kSize + 64);
+	srand(1);
+	while (text.size() < kSize) {
+		for (int i = 0; i < 60; ++i) {
+			if (mixed && rand() % 8 == 0) {
+				text.append("\xC3\xA9");
+			} else {
+				text.push_back(i % 6 == 5? ' ': 'a' + rand() % 26);
+			}
+		}
+		text.push_back('\n');
+	}
+	return text;
+}
+
+template <typename Step>
+double best_rate(size_t bytes, Step step) {
+	double best = 0;
+	for (int i = 0; i < kRounds; ++i) {
+		auto start = std::chrono::steady_clock::now();
+		step();
+		auto stop = std::chrono::steady_clock::now();
+		double secs = std::chrono::duration<double>(stop - start).count();
+		if (i == 0 || secs < best) best = secs;
+	}
+	return bytes / best / (1024 * 1024);
+}
+
+void measure(const char *label, Editor::Charset charset, const std::string &text) {
+	// Rates are in megabytes of UTF-8 text per second, in either direction,
+	// and the round trip must give back exactly what we started with.
+	std::string encoded;
+	double encode_rate = best_rate(text.size(), [&] {
+		encoded.clear();
+		Editor::encode(charset, text.data(), text.size(), encoded);
+	});
+	std::vector<char> decoded(Editor::decoded_bound(charset, encoded.size()));
+	size_t size = 0;
+	double decode_rate = best_rate(text.size(), [&] {
+		size = Editor::decode(charset, encoded.data(), encoded.size(), &decoded[0]);
+	});
+	bool same = text == std::string(decoded.data(), size);
+	printf("%-24s decode %6.0f MB/s, encode %6.0f MB/s%s\n", label,
+			decode_rate, encode_rate, same? "": "  WRONG");
+}
+} // namespace
+
+int main() {
+	std::string ascii = make_text(false);
+	std::string mixed = make_text(true);
+	measure("ASCII as UTF-16LE", Editor::Charset::UTF16LE, ascii);
+	measure("ASCII as UTF-16BE", Editor::Charset::UTF16BE, ascii);
+	measure("mixed as UTF-16LE", Editor::Charset::UTF16LE, mixed);
+	measure("ASCII as Latin-1", Editor::Charset::Latin1, ascii);
+	measure("mixed as Latin-1", Editor::Charset::Latin1, mixed);
+	return 0;
+}